@@ -36,6 +36,7 @@ const unsigned char *MicroOLED::fontsPointer[]={
 };
 
 #define I2C_FREQ 400000L
+#define SPI_FREQ 30000000L		// SPI_CLOCK_DIV2 of the 60 MHz SPI peripheral clock of the Photon
 
 /** \brief MicroOLED screen buffer.
 
@@ -112,6 +113,8 @@ void MicroOLED::setup(micro_oled_mode mode, uint8_t rst, uint8_t dc, uint8_t cs)
 	dcPin = dc;
 	csPin = cs;
 	interface = mode;
+	busStats = NULL;
+	busDC = 0;
 }
 
 /** \brief Initialisation of MicroOLED Library.
@@ -203,6 +206,7 @@ void MicroOLED::command(uint8_t c) {
 	{
 		digitalWrite(dcPin, LOW);
 		digitalWrite(csPin, LOW);
+		busDC = 0;
 		spiTransfer(c);
 		digitalWrite(csPin, HIGH);
 	}
@@ -222,6 +226,7 @@ void MicroOLED::data(uint8_t c) {
 	{
 		digitalWrite(dcPin, HIGH);
 		digitalWrite(csPin, LOW);
+		busDC = 1;
 		spiTransfer(c);
 		digitalWrite(csPin, HIGH);
 	}
@@ -869,8 +874,18 @@ void MicroOLED::spiSetup()
 	pinMode(MOSI, OUTPUT);
 }
 
+// command() and data() select the chip for each byte, one transfer per byte
 void MicroOLED::spiTransfer(uint8_t data)
 {
+	if (busStats != NULL)
+	{
+		busStats->transfers++;
+		busStats->clocks += 8;
+		if (busDC)
+			busStats->dataBytes++;
+		else
+			busStats->cmdBytes++;
+	}
 	SPI.transfer(data);
 }
 
@@ -886,4 +901,41 @@ void MicroOLED::i2cWrite(uint8_t address, uint8_t dc, uint8_t data)
 	Wire.write(dc); // If data = 0, if command = 0x40
 	Wire.write(data);
 	Wire.endTransmission();
+	if (busStats != NULL)
+	{
+		busStats->transfers++;
+		busStats->clocks += 10 + 2 * 9 + 1;
+		if (dc == I2C_DATA)
+			busStats->dataBytes++;
+		else
+			busStats->cmdBytes++;
+	}
+}
+
+/** \brief Install bus statistics.
+
+    i2cWrite() and spiTransfer() count into stats until it is replaced or NULL.
+*/
+void MicroOLED::setBusStats(micro_oled_bus_stats *stats)
+{
+	busStats = stats;
+	clearBusStats();
+}
+
+void MicroOLED::clearBusStats(void)
+{
+	if (busStats != NULL)
+		memset(busStats, 0, sizeof(*busStats));
+}
+
+/** \brief Estimated bus time in microseconds since clearBusStats().
+
+    At I2C_FREQ for I2C and SPI_FREQ for SPI, 0 without statistics.
+*/
+uint32_t MicroOLED::getBusStatsMicros(void)
+{
+	if (busStats == NULL)
+		return 0;
+	uint32_t clock = interface == MODE_I2C ? I2C_FREQ : SPI_FREQ;
+	return (uint32_t)(((uint64_t)busStats->clocks * 1000000UL) / clock);
 }
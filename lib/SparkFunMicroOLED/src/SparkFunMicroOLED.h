@@ -114,6 +114,17 @@ typedef enum COMM_MODE{
 	MODE_I2C
 } micro_oled_mode;
 
+// Bus statistics of one MicroOLED, counted in i2cWrite() and spiTransfer() while
+// installed with setBusStats(). Same time model as u8x8_bus_stats.c of U8g2:
+// I2C 10 clocks for start and address, 9 per byte, 1 for stop, the control byte
+// is overhead; SPI 8 clocks per byte.
+typedef struct {
+	uint32_t transfers;		// I2C transactions, SPI chip select cycles
+	uint32_t cmdBytes;
+	uint32_t dataBytes;
+	uint32_t clocks;		// bus clocks including protocol overhead
+} micro_oled_bus_stats;
+
 class MicroOLED : public Print
 {
 public:
@@ -178,6 +189,11 @@ public:
 	void flipVertical(bool flip);
 	void flipHorizontal(bool flip);
 
+	// Bus statistics, NULL to stop counting
+	void setBusStats(micro_oled_bus_stats *stats);
+	void clearBusStats(void);
+	uint32_t getBusStatsMicros(void);
+
 private:
 	uint8_t csPin, dcPin, rstPin;
 	uint8_t wrPin, rdPin, dPins[8];
@@ -187,6 +203,8 @@ private:
 	uint8_t foreColor,drawMode,fontWidth, fontHeight, fontType, fontStartChar, fontTotalChar, cursorX, cursorY;
 	uint16_t fontMapWidth;
 	static const unsigned char *fontsPointer[];
+	micro_oled_bus_stats *busStats;
+	uint8_t busDC;
 
 	void setup(micro_oled_mode mode, uint8_t rst, uint8_t dc, uint8_t cs);
 
@@ -179,6 +179,15 @@ class U8G2 : public Print
     void updateDisplayArea(uint8_t  tx, uint8_t ty, uint8_t tw, uint8_t th)
       { u8g2_UpdateDisplayArea(&u8g2, tx, ty, tw, th); }
 
+    /* u8x8_capture.c */
+    void writeBufferPBM(Print &p)
+      { u8x8_capture_print = &p; u8g2_WriteBufferPBM(&u8g2, u8x8_capture_print_cb); u8x8_capture_print = NULL; }
+
+
+    /* u8g2_gray4.c */
+    uint8_t isGray4(void) { return u8g2_IsGray4(&u8g2); }
+    void smoothGray4(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h)
+      { u8g2_SmoothGray4(&u8g2, x, y, w, h); }
 
     /* clib/u8g2.hvline.c */
     void setDrawColor(uint8_t color_index) { u8g2_SetDrawColor(&u8g2, color_index); }
@@ -5495,6 +5504,18 @@ class U8G2_SSD1327_EA_W128128_F_8080 : public U8G2 {
     u8x8_SetPin_8Bit_8080(getU8x8(), d0, d1, d2, d3, d4, d5, d6, d7, enable, cs, dc, reset);
   }
 };
+class U8G2_SSD1327_EA_W128128_G4_4W_SW_SPI : public U8G2 {
+  public: U8G2_SSD1327_EA_W128128_G4_4W_SW_SPI(const u8g2_cb_t *rotation, uint8_t clock, uint8_t data, uint8_t cs, uint8_t dc, uint8_t reset = U8X8_PIN_NONE) : U8G2() {
+    u8g2_Setup_ssd1327_ea_w128128_g4(&u8g2, rotation, u8x8_byte_arduino_4wire_sw_spi, u8x8_gpio_and_delay_arduino);
+    u8x8_SetPin_4Wire_SW_SPI(getU8x8(), clock, data, cs, dc, reset);
+  }
+};
+class U8G2_SSD1327_EA_W128128_G4_4W_HW_SPI : public U8G2 {
+  public: U8G2_SSD1327_EA_W128128_G4_4W_HW_SPI(const u8g2_cb_t *rotation, uint8_t cs, uint8_t dc, uint8_t reset = U8X8_PIN_NONE) : U8G2() {
+    u8g2_Setup_ssd1327_ea_w128128_g4(&u8g2, rotation, u8x8_byte_arduino_hw_spi, u8x8_gpio_and_delay_arduino);
+    u8x8_SetPin_4Wire_HW_SPI(getU8x8(), cs, dc, reset);
+  }
+};
 class U8G2_SSD1327_MIDAS_128X128_F_4W_SW_SPI : public U8G2 {
   public: U8G2_SSD1327_MIDAS_128X128_F_4W_SW_SPI(const u8g2_cb_t *rotation, uint8_t clock, uint8_t data, uint8_t cs, uint8_t dc, uint8_t reset = U8X8_PIN_NONE) : U8G2() {
     u8g2_Setup_ssd1327_midas_128x128_f(&u8g2, rotation, u8x8_byte_arduino_4wire_sw_spi, u8x8_gpio_and_delay_arduino);
@@ -5621,6 +5642,18 @@ class U8G2_SSD1327_EA_W128128_F_2ND_HW_I2C : public U8G2 {
     u8x8_SetPin_HW_I2C(getU8x8(), reset);
   }
 };
+class U8G2_SSD1327_EA_W128128_G4_SW_I2C : public U8G2 {
+  public: U8G2_SSD1327_EA_W128128_G4_SW_I2C(const u8g2_cb_t *rotation, uint8_t clock, uint8_t data, uint8_t reset = U8X8_PIN_NONE) : U8G2() {
+    u8g2_Setup_ssd1327_i2c_ea_w128128_g4(&u8g2, rotation, u8x8_byte_arduino_sw_i2c, u8x8_gpio_and_delay_arduino);
+    u8x8_SetPin_SW_I2C(getU8x8(), clock,  data,  reset);
+  }
+};
+class U8G2_SSD1327_EA_W128128_G4_HW_I2C : public U8G2 {
+  public: U8G2_SSD1327_EA_W128128_G4_HW_I2C(const u8g2_cb_t *rotation, uint8_t reset = U8X8_PIN_NONE, uint8_t clock = U8X8_PIN_NONE, uint8_t data = U8X8_PIN_NONE) : U8G2() {
+    u8g2_Setup_ssd1327_i2c_ea_w128128_g4(&u8g2, rotation, u8x8_byte_arduino_hw_i2c, u8x8_gpio_and_delay_arduino);
+    u8x8_SetPin_HW_I2C(getU8x8(), reset, clock, data);
+  }
+};
 class U8G2_SSD1327_MIDAS_128X128_F_SW_I2C : public U8G2 {
   public: U8G2_SSD1327_MIDAS_128X128_F_SW_I2C(const u8g2_cb_t *rotation, uint8_t clock, uint8_t data, uint8_t reset = U8X8_PIN_NONE) : U8G2() {
     u8g2_Setup_ssd1327_i2c_midas_128x128_f(&u8g2, rotation, u8x8_byte_arduino_sw_i2c, u8x8_gpio_and_delay_arduino);
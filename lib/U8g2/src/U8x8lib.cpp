@@ -64,6 +64,17 @@ size_t U8X8::write(uint8_t v)
 
 
 
+/*=============================================*/
+/*=== SCREEN CAPTURE ===*/
+
+Print *u8x8_capture_print = NULL;
+
+extern "C" void u8x8_capture_print_cb(const char *s)
+{
+  if ( u8x8_capture_print != NULL )
+    u8x8_capture_print->print(s);
+}
+
 /*=============================================*/
 /*=== ARDUINO GPIO & DELAY ===*/
 
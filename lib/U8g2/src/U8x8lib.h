@@ -132,6 +132,10 @@ extern "C" uint8_t u8x8_byte_arduino_hw_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t a
 extern "C" uint8_t u8x8_byte_arduino_2nd_hw_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
 extern "C" uint8_t u8x8_byte_arduino_ks0108(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
 
+/* screen capture, the output of u8g2_WriteBufferPBM() goes to u8x8_capture_print */
+extern Print *u8x8_capture_print;
+extern "C" void u8x8_capture_print_cb(const char *s);
+
 #ifdef U8X8_USE_PINS
 void u8x8_SetPin_4Wire_SW_SPI(u8x8_t *u8x8, uint8_t clock, uint8_t data, uint8_t cs, uint8_t dc, uint8_t reset);
 void u8x8_SetPin_3Wire_SW_SPI(u8x8_t *u8x8, uint8_t clock, uint8_t data, uint8_t cs, uint8_t reset);
@@ -249,6 +253,12 @@ class U8X8 : public Print
     void draw1x2Glyph(uint8_t x, uint8_t y, uint8_t encoding) {
       u8x8_Draw1x2Glyph(&u8x8, x, y, encoding); }
 
+    void draw3x3Glyph(uint8_t x, uint8_t y, uint8_t encoding) {
+      u8x8_Draw3x3Glyph(&u8x8, x, y, encoding); }
+
+    void draw4x4Glyph(uint8_t x, uint8_t y, uint8_t encoding) {
+      u8x8_Draw4x4Glyph(&u8x8, x, y, encoding); }
+
     void drawString(uint8_t x, uint8_t y, const char *s) {
       u8x8_DrawString(&u8x8, x, y, s); }
       
@@ -266,6 +276,18 @@ class U8X8 : public Print
 
     void draw1x2UTF8(uint8_t x, uint8_t y, const char *s) {
       u8x8_Draw1x2UTF8(&u8x8, x, y, s); }
+
+    void draw3x3String(uint8_t x, uint8_t y, const char *s) {
+      u8x8_Draw3x3String(&u8x8, x, y, s); }
+
+    void draw4x4String(uint8_t x, uint8_t y, const char *s) {
+      u8x8_Draw4x4String(&u8x8, x, y, s); }
+
+    void draw3x3UTF8(uint8_t x, uint8_t y, const char *s) {
+      u8x8_Draw3x3UTF8(&u8x8, x, y, s); }
+
+    void draw4x4UTF8(uint8_t x, uint8_t y, const char *s) {
+      u8x8_Draw4x4UTF8(&u8x8, x, y, s); }
       
     uint8_t getUTF8Len(const char *s) {
       return u8x8_GetUTF8Len(&u8x8, s); }
@@ -280,6 +280,7 @@ struct u8g2_struct
   uint8_t *tile_buf_ptr;	/* ptr to memory area with u8g2.display_info->tile_width * 8 * tile_buf_height bytes */
   uint8_t tile_buf_height;	/* height of the tile memory area in tile rows */
   uint8_t tile_curr_row;	/* current row for picture loop */
+  uint8_t is_gray4;		/* 1: tile_buf_ptr has 4 bit per pixel (tile_width * 32 * tile_buf_height bytes), see u8g2_gray4.c */
   
   /* dimension of the buffer in pixel */
   u8g2_uint_t pixel_buf_width;		/* equal to tile_buf_width*8 */
@@ -1080,6 +1081,28 @@ uint8_t u8g2_NextPage(u8g2_t *u8g2);
 
 void u8g2_UpdateDisplayArea(u8g2_t *u8g2, uint8_t  tx, uint8_t ty, uint8_t tw, uint8_t th);
 
+/*==========================================*/
+/* u8x8_capture.c */
+
+void u8g2_WriteBufferPBM(u8g2_t *u8g2, void (*out)(const char *s));
+
+
+/*==========================================*/
+/* u8g2_gray4.c */
+
+/*
+  4 bit per pixel full buffer for 16 level gray displays (SSD1327).
+  In this mode the draw color is the gray level (0..15), XOR is not available.
+  The buffer requires 4 times the memory of the monochrome full buffer.
+*/
+uint8_t *u8g2_m_16_16_g4(uint8_t *page_cnt);
+void u8g2_ll_hvline_gray4(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir);
+void u8g2_SetupBufferGray4(u8g2_t *u8g2, uint8_t *buf, uint8_t tile_buf_height, const u8g2_cb_t *u8g2_cb);
+void u8g2_Setup_ssd1327_ea_w128128_g4(u8g2_t *u8g2, const u8g2_cb_t *rotation, u8x8_msg_cb byte_cb, u8x8_msg_cb gpio_and_delay_cb);
+void u8g2_Setup_ssd1327_i2c_ea_w128128_g4(u8g2_t *u8g2, const u8g2_cb_t *rotation, u8x8_msg_cb byte_cb, u8x8_msg_cb gpio_and_delay_cb);
+void u8g2_SmoothGray4(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h);
+#define u8g2_IsGray4(u8g2) ((u8g2)->is_gray4)
+
 
 /*==========================================*/
 /* u8g2_ll_hvline.c */
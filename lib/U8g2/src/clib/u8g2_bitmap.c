@@ -40,6 +40,158 @@ void u8g2_SetBitmapMode(u8g2_t *u8g2, uint8_t is_transparent) {
   u8g2->bitmap_transparency = is_transparent;
 }
 
+/*=================================================*/
+/*
+  Blit engine for u8g2_ll_hvline_vertical_top_lsb buffers (SSD13xx, UC1701, ...)
+
+  Instead of decomposing a bitmap into one u8g2_DrawHVLine call per pixel, 
+  clipping is done once per bitmap. Then 8 source rows are collected for each 
+  group of 8 source columns and transposed into the vertical byte format 
+  of the tile buffer, so that each tile buffer byte is modified only once
+  per page band.
+  
+  The blit is only used for U8G2_R0. All other rotations use the 
+  pixel based procedures below, which produce the same result.
+*/
+
+#define U8G2_BLIT_LSB_FIRST 0
+#define U8G2_BLIT_MSB_FIRST 1
+
+/*
+  8x8 bit matrix transpose, Hacker's Delight, 7-3
+  a[i] bit (7-j) will become b[j] bit (7-i)
+*/
+static void u8g2_transpose8(const uint8_t *a, uint8_t *b)
+{
+  uint32_t x, y, t;
+  
+  x = ((uint32_t)a[0]<<24) | ((uint32_t)a[1]<<16) | ((uint32_t)a[2]<<8) | a[3];
+  y = ((uint32_t)a[4]<<24) | ((uint32_t)a[5]<<16) | ((uint32_t)a[6]<<8) | a[7];
+
+  t = (x ^ (x >> 7)) & 0x00AA00AAUL;  x = x ^ t ^ (t << 7);
+  t = (y ^ (y >> 7)) & 0x00AA00AAUL;  y = y ^ t ^ (t << 7);
+
+  t = (x ^ (x >> 14)) & 0x0000CCCCUL;  x = x ^ t ^ (t << 14);
+  t = (y ^ (y >> 14)) & 0x0000CCCCUL;  y = y ^ t ^ (t << 14);
+
+  t = (x & 0xF0F0F0F0UL) | ((y >> 4) & 0x0F0F0F0FUL);
+  y = ((x << 4) & 0xF0F0F0F0UL) | (y & 0x0F0F0F0FUL);
+  x = t;
+
+  b[0] = x >> 24; b[1] = x >> 16; b[2] = x >> 8; b[3] = x;
+  b[4] = y >> 24; b[5] = y >> 16; b[6] = y >> 8; b[7] = y;
+}
+
+/* apply a draw color (0, 1 or 2) to the bits of mask */
+static uint8_t u8g2_blit_apply_color(uint8_t dest, uint8_t mask, uint8_t color)
+{
+  if ( color == 0 )
+    return dest & ~mask;
+  if ( color == 1 )
+    return dest | mask;
+  return dest ^ mask;
+}
+
+/*
+  x, y, w, h	bitmap position and size on the display
+  blen		bytes per bitmap line
+  is_msb_first	U8G2_BLIT_LSB_FIRST (XBM) or U8G2_BLIT_MSB_FIRST (u8glib bitmap)
+  is_pgm		1 if the bitmap is located in PROGMEM
+  returns 0 if the blit can not be applied, the caller must draw the bitmap in this case
+*/
+static uint8_t u8g2_blit_vertical_top_lsb(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h, u8g2_uint_t blen, const uint8_t *bitmap, uint8_t is_msb_first, uint8_t is_pgm)
+{
+  uint16_t x0, x1, y0, y1;	/* visible area in bitmap coordinates */
+  uint16_t r, c, k, by, band_end;
+  uint16_t tile_width;
+  uint8_t m[8], t[8];
+  uint8_t row_mask, fg, bg, idx;
+  uint8_t color = u8g2->draw_color;
+  uint8_t ncolor = (color == 0 ? 1 : 0);
+  uint8_t *page;
+  const uint8_t *src;
+  
+  if ( u8g2->cb != U8G2_R0 )
+    return 0;
+  if ( u8g2->ll_hvline != u8g2_ll_hvline_vertical_top_lsb )
+    return 0;
+  /* negative positions wrap around, leave them to the clipping of the hvline procedures */
+  if ( (uint16_t)x + (uint16_t)w > (u8g2_uint_t)~(u8g2_uint_t)0 )
+    return 0;
+  if ( (uint16_t)y + (uint16_t)h > (u8g2_uint_t)~(u8g2_uint_t)0 )
+    return 0;
+  
+#ifdef U8G2_WITH_CLIP_WINDOW_SUPPORT
+  if ( u8g2->is_page_clip_window_intersection == 0 )
+    return 1;
+#endif /* U8G2_WITH_CLIP_WINDOW_SUPPORT */
+
+  /* clip once against the user window (page window and clip window) */
+  x0 = 0;
+  if ( x < u8g2->user_x0 )
+    x0 = u8g2->user_x0 - x;
+  x1 = w;
+  if ( (uint16_t)x + w > u8g2->user_x1 )
+    x1 = ( u8g2->user_x1 > x ) ? u8g2->user_x1 - x : 0;
+  y0 = 0;
+  if ( y < u8g2->user_y0 )
+    y0 = u8g2->user_y0 - y;
+  y1 = h;
+  if ( (uint16_t)y + h > u8g2->user_y1 )
+    y1 = ( u8g2->user_y1 > y ) ? u8g2->user_y1 - y : 0;
+  if ( x0 >= x1 || y0 >= y1 )
+    return 1;
+  
+  tile_width = u8g2_GetU8x8(u8g2)->display_info->tile_width;
+  
+  r = y0;
+  while( r < y1 )
+  {
+    /* one page band of the tile buffer */
+    by = y + r - u8g2->pixel_curr_row;
+    page = u8g2->tile_buf_ptr + (by & ~7) * tile_width + x;
+    band_end = r + 8 - (by & 7);
+    if ( band_end > y1 )
+      band_end = y1;
+    
+    row_mask = 0;
+    for( idx = 0; idx < 8; idx++ )
+      m[idx] = 0;
+    for( k = r; k < band_end; k++ )
+      row_mask |= 1 << ((by & 7) + k - r);
+    
+    for( k = x0 >> 3; k <= (x1 - 1) >> 3; k++ )
+    {
+      /* collect 8 source rows of this byte column, bit position = row within the page */
+      for( c = r; c < band_end; c++ )
+      {
+        src = bitmap + c * blen + k;
+        idx = (by & 7) + c - r;
+        m[7-idx] = is_pgm ? u8x8_pgm_read(src) : *src;
+      }
+      u8g2_transpose8(m, t);
+      
+      for( c = 0; c < 8; c++ )
+      {
+        if ( k*8+c < x0 )
+          continue;
+        if ( k*8+c >= x1 )
+          break;
+        fg = is_msb_first ? t[c] : t[7-c];
+        fg &= row_mask;
+        page[k*8+c] = u8g2_blit_apply_color(page[k*8+c], fg, color);
+        if ( u8g2->bitmap_transparency == 0 )
+        {
+          bg = ~fg & row_mask;
+          page[k*8+c] = u8g2_blit_apply_color(page[k*8+c], bg, ncolor);
+        }
+      }
+    }
+    r = band_end;
+  }
+  return 1;
+}
+
 /*
   x,y 	Position on the display
   len		Length of bitmap line in pixel. Note: This differs from u8glib which had a bytecount here.
@@ -93,6 +245,9 @@ void u8g2_DrawBitmap(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t cnt
     return;
 #endif /* U8G2_WITH_INTERSECTION */
   
+  if ( u8g2_blit_vertical_top_lsb(u8g2, x, y, w, h, cnt, bitmap, U8G2_BLIT_MSB_FIRST, 0) != 0 )
+    return;
+  
   while( h > 0 )
   {
     u8g2_DrawHorizontalBitmap(u8g2, x, y, w, bitmap);
@@ -147,6 +302,9 @@ void u8g2_DrawXBM(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g
     return;
 #endif /* U8G2_WITH_INTERSECTION */
   
+  if ( u8g2_blit_vertical_top_lsb(u8g2, x, y, w, h, blen, bitmap, U8G2_BLIT_LSB_FIRST, 0) != 0 )
+    return;
+  
   while( h > 0 )
   {
     u8g2_DrawHXBM(u8g2, x, y, w, bitmap);
@@ -206,6 +364,9 @@ void u8g2_DrawXBMP(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8
     return;
 #endif /* U8G2_WITH_INTERSECTION */
   
+  if ( u8g2_blit_vertical_top_lsb(u8g2, x, y, w, h, blen, bitmap, U8G2_BLIT_LSB_FIRST, 1) != 0 )
+    return;
+  
   while( h > 0 )
   {
     u8g2_DrawHXBMP(u8g2, x, y, w, bitmap);
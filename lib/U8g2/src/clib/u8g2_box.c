@@ -82,6 +82,8 @@ void u8g2_DrawFrame(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u
 
 
 
+extern void u8g2_draw_disc_columns(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t x1, u8g2_uint_t y1, u8g2_uint_t rad, uint8_t option);
+
 void u8g2_DrawRBox(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h, u8g2_uint_t r)
 {
   u8g2_uint_t xl, yu;
@@ -107,6 +109,20 @@ void u8g2_DrawRBox(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8
   yl -= r; 
   yl -= 1;
 
+  if ( xl <= xr && yu <= yl )
+  {
+    /* 
+      all four corners together with the left and right edge: 
+      one vertical line per column, followed by the middle part
+    */
+    u8g2_draw_disc_columns(u8g2, xl, yu, xr, yl, r, U8G2_DRAW_ALL);
+    xl++;
+    if ( xl < xr )
+      u8g2_DrawBox(u8g2, xl, y, xr-xl, h);
+    return;
+  }
+
+  /* the corners overlap */
   u8g2_DrawDisc(u8g2, xl, yu, r, U8G2_DRAW_UPPER_LEFT);
   u8g2_DrawDisc(u8g2, xr, yu, r, U8G2_DRAW_UPPER_RIGHT);
   u8g2_DrawDisc(u8g2, xl, yl, r, U8G2_DRAW_LOWER_LEFT);
@@ -43,6 +43,8 @@ void u8g2_ClearBuffer(u8g2_t *u8g2)
   cnt = u8g2_GetU8x8(u8g2)->display_info->tile_width;
   cnt *= u8g2->tile_buf_height;
   cnt *= 8;
+  if ( u8g2->is_gray4 )
+    cnt *= 4;
   memset(u8g2->tile_buf_ptr, 0, cnt);
 }
 
@@ -81,6 +83,15 @@ static void u8g2_send_buffer(u8g2_t *u8g2)
   dest_row = u8g2->tile_curr_row;
   dest_max = u8g2_GetU8x8(u8g2)->display_info->tile_height;
   
+  if ( u8g2->is_gray4 )
+  {
+    /* the gray buffer has the layout of the display RAM: send all rows at once */
+    if ( src_max > dest_max - dest_row )
+      src_max = dest_max - dest_row;
+    u8x8_DrawGray4(u8g2_GetU8x8(u8g2), 0, dest_row, u8g2_GetU8x8(u8g2)->display_info->tile_width, src_max, u8g2->tile_buf_ptr);
+    return;
+  }
+  
   do
   {
     u8g2_send_tile_row(u8g2, src_row, dest_row);
@@ -149,6 +160,7 @@ uint8_t u8g2_NextPage(u8g2_t *u8g2)
     - Any display rotation/mirror is ignored
     - Only works with displays, which support U8x8 API
     - Will not send the e-paper refresh message (will probably not work with e-paper devices)
+    - In gray mode (u8g2_gray4.c) the complete tile rows ty..ty+th-1 are sent
 */
 void u8g2_UpdateDisplayArea(u8g2_t *u8g2, uint8_t  tx, uint8_t ty, uint8_t tw, uint8_t th)
 {
@@ -162,6 +174,13 @@ void u8g2_UpdateDisplayArea(u8g2_t *u8g2, uint8_t  tx, uint8_t ty, uint8_t tw, u
   page_size = u8g2->pixel_buf_width;  /* 8*u8g2->u8g2_GetU8x8(u8g2)->display_info->tile_width */
     
   ptr = u8g2_GetBufferPtr(u8g2);
+  if ( u8g2->is_gray4 )
+  {
+    /* a tile row has 8 pixel rows of pixel_buf_width/2 bytes */
+    ptr += page_size*ty*4;
+    u8x8_DrawGray4( u8g2_GetU8x8(u8g2), 0, ty, u8g2_GetU8x8(u8g2)->display_info->tile_width, th, ptr );
+    return;
+  }
   ptr += tx*8;
   ptr += page_size*ty;
   
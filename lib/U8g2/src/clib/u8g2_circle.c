@@ -124,46 +124,73 @@ void u8g2_DrawCircle(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t r
 /*==============================================*/
 /* Disk */
 
-static void u8g2_draw_disc_section(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t x0, u8g2_uint_t y0, uint8_t option) U8G2_NOINLINE;
+/*
+  Filled discs are drawn column by column: The Bresenham loop emits each 
+  column of the disc exactly once with its final height and the upper and 
+  lower part of a column are merged into one vertical line. Vertical lines 
+  are written bytewise into vertical_top_lsb tile buffers, so clipping is 
+  done once per column and every byte is modified only once.
+  
+  The disc may be stretched: The left half is centered at x0, the right half 
+  at x1, the upper half at y0 and the lower half at y1 (x0 <= x1, y0 <= y1).
+  The area between the halves is filled. u8g2_DrawRBox() uses this to draw 
+  the corners together with the left and right edge of the box.
+*/
 
-static void u8g2_draw_disc_section(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t x0, u8g2_uint_t y0, uint8_t option)
+static void u8g2_draw_disc_vline(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y0, u8g2_uint_t y1, u8g2_uint_t h, uint8_t is_upper, uint8_t is_lower)
 {
-    /* upper right */
-    if ( option & U8G2_DRAW_UPPER_RIGHT )
-    {
-      u8g2_DrawVLine(u8g2, x0+x, y0-y, y+1);
-      u8g2_DrawVLine(u8g2, x0+y, y0-x, x+1);
-    }
-    
-    /* upper left */
-    if ( option & U8G2_DRAW_UPPER_LEFT )
-    {
-      u8g2_DrawVLine(u8g2, x0-x, y0-y, y+1);
-      u8g2_DrawVLine(u8g2, x0-y, y0-x, x+1);
-    }
-    
-    /* lower right */
-    if ( option & U8G2_DRAW_LOWER_RIGHT )
-    {
-      u8g2_DrawVLine(u8g2, x0+x, y0, y+1);
-      u8g2_DrawVLine(u8g2, x0+y, y0, x+1);
-    }
-    
-    /* lower left */
-    if ( option & U8G2_DRAW_LOWER_LEFT )
+  uint16_t len;
+  
+  if ( is_upper != 0 && is_lower != 0 )
+  {
+    len = (u8g2_uint_t)(y1 - y0);
+    len += h;
+    len += h;
+    len++;
+    if ( len <= (u8g2_uint_t)~(u8g2_uint_t)0 )
     {
-      u8g2_DrawVLine(u8g2, x0-x, y0, y+1);
-      u8g2_DrawVLine(u8g2, x0-y, y0, x+1);
+      u8g2_DrawVLine(u8g2, x, y0-h, len);
+      return;
     }
+    /* does not fit into u8g2_uint_t, draw the middle part separately */
+    if ( y1 - y0 > 1 )
+      u8g2_DrawVLine(u8g2, x, y0+1, y1-y0-1);
+  }
+  if ( is_upper != 0 )
+    u8g2_DrawVLine(u8g2, x, y0-h, h+1);
+  if ( is_lower != 0 )
+    u8g2_DrawVLine(u8g2, x, y1, h+1);
 }
 
-static void u8g2_draw_disc(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t rad, uint8_t option)
+/* c: distance of the column from the center, h: height of the column */
+static void u8g2_draw_disc_column(u8g2_t *u8g2, u8g2_uint_t c, u8g2_uint_t h, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t x1, u8g2_uint_t y1, uint8_t option) U8G2_NOINLINE;
+
+static void u8g2_draw_disc_column(u8g2_t *u8g2, u8g2_uint_t c, u8g2_uint_t h, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t x1, u8g2_uint_t y1, uint8_t option)
+{
+  if ( c == 0 && x0 == x1 )
+  {
+    /* left and right column are the same */
+    u8g2_draw_disc_vline(u8g2, x0, y0, y1, h, 
+      option & (U8G2_DRAW_UPPER_RIGHT|U8G2_DRAW_UPPER_LEFT), 
+      option & (U8G2_DRAW_LOWER_RIGHT|U8G2_DRAW_LOWER_LEFT));
+    return;
+  }
+  
+  /* right */
+  u8g2_draw_disc_vline(u8g2, x1+c, y0, y1, h, option & U8G2_DRAW_UPPER_RIGHT, option & U8G2_DRAW_LOWER_RIGHT);
+  
+  /* left */
+  u8g2_draw_disc_vline(u8g2, x0-c, y0, y1, h, option & U8G2_DRAW_UPPER_LEFT, option & U8G2_DRAW_LOWER_LEFT);
+}
+
+void u8g2_draw_disc_columns(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t x1, u8g2_uint_t y1, u8g2_uint_t rad, uint8_t option)
 {
   u8g2_int_t f;
   u8g2_int_t ddF_x;
   u8g2_int_t ddF_y;
   u8g2_uint_t x;
   u8g2_uint_t y;
+  uint16_t y_col;	/* smallest column, which was already drawn with the height x */
 
   f = 1;
   f -= rad;
@@ -173,13 +200,23 @@ static void u8g2_draw_disc(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_ui
   ddF_y *= 2;
   x = 0;
   y = rad;
+  y_col = rad;
+  y_col++;
 
-  u8g2_draw_disc_section(u8g2, x, y, x0, y0, option);
-  
-  while ( x < y )
+  for(;;)
   {
+    /* column x has the height y, unless it has been drawn already */
+    if ( x < y_col )
+      u8g2_draw_disc_column(u8g2, x, y, x0, y0, x1, y1, option);
+    
+    if ( x >= y )
+      break;
+    
     if (f >= 0) 
     {
+      /* y will change, so column y gets its final height x */
+      u8g2_draw_disc_column(u8g2, y, x, x0, y0, x1, y1, option);
+      y_col = y;
       y--;
       ddF_y += 2;
       f += ddF_y;
@@ -187,9 +224,14 @@ static void u8g2_draw_disc(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_ui
     x++;
     ddF_x += 2;
     f += ddF_x;
-
-    u8g2_draw_disc_section(u8g2, x, y, x0, y0, option);    
   }
+  
+  /* column y of the last step is covered by the x columns if y <= x */
+}
+
+static void u8g2_draw_disc(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t rad, uint8_t option)
+{
+  u8g2_draw_disc_columns(u8g2, x0, y0, x0, y0, rad, option);
 }
 
 void u8g2_DrawDisc(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t rad, uint8_t option)
@@ -346,33 +388,13 @@ void u8g2_DrawEllipse(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t
 /*==============================================*/
 /* Filled Ellipse */
 
-static void u8g2_draw_filled_ellipse_section(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t x0, u8g2_uint_t y0, uint8_t option) U8G2_NOINLINE;
-static void u8g2_draw_filled_ellipse_section(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t x0, u8g2_uint_t y0, uint8_t option)
-{
-    /* upper right */
-    if ( option & U8G2_DRAW_UPPER_RIGHT )
-    {
-      u8g2_DrawVLine(u8g2, x0+x, y0-y, y+1);
-    }
-    
-    /* upper left */
-    if ( option & U8G2_DRAW_UPPER_LEFT )
-    {
-      u8g2_DrawVLine(u8g2, x0-x, y0-y, y+1);
-    }
-    
-    /* lower right */
-    if ( option & U8G2_DRAW_LOWER_RIGHT )
-    {
-      u8g2_DrawVLine(u8g2, x0+x, y0, y+1);
-    }
-    
-    /* lower left */
-    if ( option & U8G2_DRAW_LOWER_LEFT )
-    {
-      u8g2_DrawVLine(u8g2, x0-x, y0, y+1);
-    }
-}
+/*
+  Like the disc, the filled ellipse is drawn with one vertical line per 
+  column. The second half of the Foley algorithm (flat part, x increments 
+  with each step) is calculated first. Each x of this part is a new column. 
+  The first part (steep part, y increments with each step) then only 
+  draws the columns outside of the flat part, each with its final height.
+*/
 
 static void u8g2_draw_filled_ellipse(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t rx, u8g2_uint_t ry, uint8_t option)
 {
@@ -382,6 +404,7 @@ static void u8g2_draw_filled_ellipse(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y
   u8g2_long_t rxrx2;
   u8g2_long_t ryry2;
   u8g2_long_t stopx, stopy;
+  uint16_t x_col;	/* number of columns drawn by the flat part */
   
   rxrx2 = rx;
   rxrx2 *= rx;
@@ -391,40 +414,8 @@ static void u8g2_draw_filled_ellipse(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y
   ryry2 *= ry;
   ryry2 *= 2;
   
-  x = rx;
-  y = 0;
+  /* flat part */
   
-  xchg = 1;
-  xchg -= rx;
-  xchg -= rx;
-  xchg *= ry;
-  xchg *= ry;
-  
-  ychg = rx;
-  ychg *= rx;
-  
-  err = 0;
-  
-  stopx = ryry2;
-  stopx *= rx;
-  stopy = 0;
-  
-  while( stopx >= stopy )
-  {
-    u8g2_draw_filled_ellipse_section(u8g2, x, y, x0, y0, option);
-    y++;
-    stopy += rxrx2;
-    err += ychg;
-    ychg += rxrx2;
-    if ( 2*err+xchg > 0 )
-    {
-      x--;
-      stopx -= ryry2;
-      err += xchg;
-      xchg += ryry2;      
-    }
-  }
-
   x = 0;
   y = ry;
   
@@ -444,10 +435,12 @@ static void u8g2_draw_filled_ellipse(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y
   stopy = rxrx2;
   stopy *= ry;
   
+  x_col = 0;
 
   while( stopx <= stopy )
   {
-    u8g2_draw_filled_ellipse_section(u8g2, x, y, x0, y0, option);
+    u8g2_draw_disc_column(u8g2, x, y, x0, y0, x0, y0, option);
+    x_col++;
     x++;
     stopx += ryry2;
     err += xchg;
@@ -461,6 +454,46 @@ static void u8g2_draw_filled_ellipse(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y
     }
   }
   
+  /* steep part */
+  
+  x = rx;
+  y = 0;
+  
+  xchg = 1;
+  xchg -= rx;
+  xchg -= rx;
+  xchg *= ry;
+  xchg *= ry;
+  
+  ychg = rx;
+  ychg *= rx;
+  
+  err = 0;
+  
+  stopx = ryry2;
+  stopx *= rx;
+  stopy = 0;
+  
+  while( stopx >= stopy )
+  {
+    stopy += rxrx2;
+    err += ychg;
+    ychg += rxrx2;
+    if ( 2*err+xchg > 0 || stopx < stopy )
+    {
+      /* x will change or this is the last step, so column x gets its final height y */
+      if ( x >= x_col )
+	u8g2_draw_disc_column(u8g2, x, y, x0, y0, x0, y0, option);
+    }
+    y++;
+    if ( 2*err+xchg > 0 )
+    {
+      x--;
+      stopx -= ryry2;
+      err += xchg;
+      xchg += ryry2;      
+    }
+  }
 }
 
 void u8g2_DrawFilledEllipse(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t rx, u8g2_uint_t ry, uint8_t option)
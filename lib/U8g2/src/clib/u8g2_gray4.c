@@ -0,0 +1,240 @@
+/*
+
+  u8g2_gray4.c
+
+  Universal 8bit Graphics Library (https://github.com/olikraus/u8g2/)
+
+  Copyright (c) 2016, olikraus@gmail.com
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, 
+  are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this list 
+    of conditions and the following disclaimer.
+    
+  * Redistributions in binary form must reproduce the above copyright notice, this 
+    list of conditions and the following disclaimer in the documentation and/or other 
+    materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND 
+  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR 
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  
+
+*/
+
+
+/*
+  4 bit per pixel (16 level gray) full buffer for the SSD1327.
+
+  The monochrome buffer is expanded to 4 bit per pixel by the display 
+  procedure for each tile on every send (u8x8_ssd1327_8to32). 
+  The gray buffer instead uses the layout of the SSD1327 display RAM:
+  pixel rows of tile_width*4 bytes, the left pixel in the upper nibble. 
+  u8g2_SendBuffer() streams it with a single U8X8_MSG_DISPLAY_DRAW_GRAY4
+  message without conversion.
+  
+  The draw color is the gray level 0..15. Fonts, boxes, lines etc. are 
+  drawn with this level, u8g2_SmoothGray4() adds gray edges afterwards.
+  
+  The buffer needs 8 KB for a 128x128 display. It is only linked if one of
+  the _g4 setup procedures is used:
+  
+    u8g2_Setup_ssd1327_i2c_ea_w128128_g4(&u8g2, U8G2_R0, u8x8_byte_arduino_hw_i2c, u8x8_gpio_and_delay_arduino);
+*/
+
+#include "u8g2.h"
+#include <string.h>
+
+uint8_t *u8g2_m_16_16_g4(uint8_t *page_cnt)
+{
+  static uint8_t buf[8192];
+  *page_cnt = 16;
+  return buf;
+}
+
+/*
+  x,y		Upper left position of the line within the local buffer (not the display!)
+  len		length of the line in pixel, len must not be 0
+  dir		0: horizontal line (left to right)
+		1: vertical line (top to bottom)
+  asumption: 
+    all clipping done
+*/
+void u8g2_ll_hvline_gray4(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir)
+{
+  uint16_t offset;
+  uint16_t stride;
+  uint8_t *ptr;
+  uint8_t c = u8g2->draw_color;
+  uint8_t keep_mask;
+  
+  stride = u8g2_GetU8x8(u8g2)->display_info->tile_width;
+  stride *= 4;		/* bytes per pixel row */
+  offset = y;
+  offset *= stride;
+  offset += x >> 1;
+  ptr = u8g2->tile_buf_ptr;
+  ptr += offset;
+  
+  if ( dir == 0 )
+  {
+    /* odd start position: the right pixel of the first byte */
+    if ( x & 1 )
+    {
+      *ptr = (*ptr & 0x0f0) | c;
+      ptr++;
+      len--;
+    }
+    /* two pixel per byte */
+    while( len >= 2 )
+    {
+      *ptr++ = (c << 4) | c;
+      len -= 2;
+    }
+    /* remaining left pixel */
+    if ( len != 0 )
+      *ptr = (*ptr & 0x0f) | (c << 4);
+  }
+  else
+  {
+    if ( x & 1 )
+    {
+      keep_mask = 0x0f0;
+    }
+    else
+    {
+      keep_mask = 0x00f;
+      c <<= 4;
+    }
+    do
+    {
+      *ptr = (*ptr & keep_mask) | c;
+      ptr += stride;
+      len--;
+    } while( len != 0 );
+  }
+}
+
+/* like u8g2_SetupBuffer, but for a buffer of u8g2_m_16_16_g4() */
+void u8g2_SetupBufferGray4(u8g2_t *u8g2, uint8_t *buf, uint8_t tile_buf_height, const u8g2_cb_t *u8g2_cb)
+{
+  u8g2_SetupBuffer(u8g2, buf, tile_buf_height, u8g2_ll_hvline_gray4, u8g2_cb);
+  u8g2->is_gray4 = 1;
+  u8g2->draw_color = 15;
+}
+
+/* ssd1327 g4 */
+void u8g2_Setup_ssd1327_ea_w128128_g4(u8g2_t *u8g2, const u8g2_cb_t *rotation, u8x8_msg_cb byte_cb, u8x8_msg_cb gpio_and_delay_cb)
+{
+  uint8_t tile_buf_height;
+  uint8_t *buf;
+  u8g2_SetupDisplay(u8g2, u8x8_d_ssd1327_ea_w128128, u8x8_cad_001, byte_cb, gpio_and_delay_cb);
+  buf = u8g2_m_16_16_g4(&tile_buf_height);
+  u8g2_SetupBufferGray4(u8g2, buf, tile_buf_height, rotation);
+}
+void u8g2_Setup_ssd1327_i2c_ea_w128128_g4(u8g2_t *u8g2, const u8g2_cb_t *rotation, u8x8_msg_cb byte_cb, u8x8_msg_cb gpio_and_delay_cb)
+{
+  uint8_t tile_buf_height;
+  uint8_t *buf;
+  u8g2_SetupDisplay(u8g2, u8x8_d_ssd1327_ea_w128128, u8x8_cad_ssd13xx_i2c, byte_cb, gpio_and_delay_cb);
+  buf = u8g2_m_16_16_g4(&tile_buf_height);
+  u8g2_SetupBufferGray4(u8g2, buf, tile_buf_height, rotation);
+}
+
+/*============================================*/
+
+static uint8_t u8g2_gray4_get(uint8_t *buf, uint16_t stride, u8g2_uint_t x, u8g2_uint_t y)
+{
+  uint8_t v = buf[y*stride + (x >> 1)];
+  if ( x & 1 )
+    return v & 15;
+  return v >> 4;
+}
+
+static void u8g2_gray4_set(uint8_t *buf, uint16_t stride, u8g2_uint_t x, u8g2_uint_t y, uint8_t c)
+{
+  uint8_t *ptr = buf + y*stride + (x >> 1);
+  if ( x & 1 )
+    *ptr = (*ptr & 0x0f0) | c;
+  else
+    *ptr = (*ptr & 0x00f) | (c << 4);
+}
+
+/*
+  Antialias the edges of everything, which has been drawn with the current 
+  draw color (e.g. the glyphs of a large font) within the given area.
+  Each pixel below the draw color gets a gray level, which depends on the 
+  number of neighbours with the draw color: 2/16 of the draw color for each 
+  horizontal or vertical neighbour and 1/16 for each diagonal neighbour.
+  The pixel is only changed if this level is brighter.
+  
+  The arguments are buffer coordinates, any u8g2 rotation is ignored
+  (see u8g2_UpdateDisplayArea()). The area is clipped to the buffer. 
+  Only available in gray mode.
+*/
+void u8g2_SmoothGray4(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h)
+{
+  uint8_t *buf = u8g2->tile_buf_ptr;
+  uint16_t stride;
+  u8g2_uint_t bw, bh;
+  u8g2_uint_t xx, yy, x1, y1;
+  uint8_t fg = u8g2->draw_color;
+  uint8_t sum, level;
+  
+  if ( u8g2->is_gray4 == 0 || fg == 0 )
+    return;
+  
+  bw = u8g2->pixel_buf_width;
+  bh = u8g2->pixel_buf_height;
+  stride = bw / 2;
+  if ( x >= bw || y >= bh )
+    return;
+  x1 = x + w;
+  if ( x1 > bw || x1 < x )
+    x1 = bw;
+  y1 = y + h;
+  if ( y1 > bh || y1 < y )
+    y1 = bh;
+  
+  for( yy = y; yy < y1; yy++ )
+  {
+    for( xx = x; xx < x1; xx++ )
+    {
+      level = u8g2_gray4_get(buf, stride, xx, yy);
+      if ( level >= fg )
+	continue;
+      
+      /* new edge pixels are below fg, so they do not count as neighbours */
+      sum = 0;
+      if ( xx > 0 && u8g2_gray4_get(buf, stride, xx-1, yy) >= fg ) sum += 2;
+      if ( xx+1 < bw && u8g2_gray4_get(buf, stride, xx+1, yy) >= fg ) sum += 2;
+      if ( yy > 0 )
+      {
+	if ( u8g2_gray4_get(buf, stride, xx, yy-1) >= fg ) sum += 2;
+	if ( xx > 0 && u8g2_gray4_get(buf, stride, xx-1, yy-1) >= fg ) sum++;
+	if ( xx+1 < bw && u8g2_gray4_get(buf, stride, xx+1, yy-1) >= fg ) sum++;
+      }
+      if ( yy+1 < bh )
+      {
+	if ( u8g2_gray4_get(buf, stride, xx, yy+1) >= fg ) sum += 2;
+	if ( xx > 0 && u8g2_gray4_get(buf, stride, xx-1, yy+1) >= fg ) sum++;
+	if ( xx+1 < bw && u8g2_gray4_get(buf, stride, xx+1, yy+1) >= fg ) sum++;
+      }
+      
+      sum = (fg * sum + 8) >> 4;
+      if ( sum > level )
+	u8g2_gray4_set(buf, stride, xx, yy, sum);
+    }
+  }
+}
@@ -245,11 +245,18 @@ void u8g2_DrawPixel(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y)
 
   7 Jan 2017: Allow color value 2 for XOR operation.
   
+  In gray mode (u8g2_gray4.c) the color is the gray level 0..15.
+  
 */
 void u8g2_SetDrawColor(u8g2_t *u8g2, uint8_t color)
 {
   u8g2->draw_color = color;	/* u8g2_SetDrawColor: just assign the argument */ 
-  if ( color >= 3 )
+  if ( u8g2->is_gray4 )
+  {
+    if ( color >= 16 )
+      u8g2->draw_color = 15;	/* u8g2_SetDrawColor: brightest level if arg is invalid */
+  }
+  else if ( color >= 3 )
     u8g2->draw_color = 1;	/* u8g2_SetDrawColor: make color as one if arg is invalid */
 }
 
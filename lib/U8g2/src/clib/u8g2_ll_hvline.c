@@ -87,16 +87,6 @@ void u8g2_ll_hvline_vertical_top_lsb(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y,
   /* bytes are vertical, lsb on top (y=0), msb at bottom (y=7) */
   bit_pos = y;		/* overflow truncate is ok here... */
   bit_pos &= 7; 	/* ... because only the lowest 3 bits are needed */
-  mask = 1;
-  mask <<= bit_pos;
-
-  or_mask = 0;
-  xor_mask = 0;
-  if ( u8g2->draw_color <= 1 )
-    or_mask  = mask;
-  if ( u8g2->draw_color != 1 )
-    xor_mask = mask;
-
 
   offset = y;		/* y might be 8 or 16 bit, but we need 16 bit, so use a 16 bit variable */
   offset &= ~7;
@@ -107,6 +97,14 @@ void u8g2_ll_hvline_vertical_top_lsb(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y,
   
   if ( dir == 0 )
   {
+      mask = 1;
+      mask <<= bit_pos;
+      or_mask = 0;
+      xor_mask = 0;
+      if ( u8g2->draw_color <= 1 )
+	or_mask  = mask;
+      if ( u8g2->draw_color != 1 )
+	xor_mask = mask;
       do
       {
 #ifdef __unix
@@ -119,35 +117,38 @@ void u8g2_ll_hvline_vertical_top_lsb(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y,
       } while( len != 0 );
   }
   else
-  {    
-    do
+  {
+    /* 
+      vertical line: all pixels of the line within one byte are written at once.
+      This is also the direction of horizontal lines for U8G2_R1 and U8G2_R3.
+      rest is the number of remaining pixels, counted from the lsb of the current byte
+    */
+    uint16_t rest = len;
+    rest += bit_pos;
+    
+    mask = 0xff;
+    mask <<= bit_pos;
+    while( rest > 8 )
     {
 #ifdef __unix
       assert(ptr < max_ptr);
 #endif
-      *ptr |= or_mask;
-      *ptr ^= xor_mask;
-      
-      bit_pos++;
-      bit_pos &= 7;
-
-      len--;
-
-      if ( bit_pos == 0 )
-      {
-	ptr+=u8g2->pixel_buf_width;	/* 6 Jan 17: Changed u8g2->width to u8g2->pixel_buf_width, issue #148 */
-		
-	if ( u8g2->draw_color <= 1 )
-	  or_mask  = 1;
-	if ( u8g2->draw_color != 1 )
-	  xor_mask = 1;
-      }
-      else
-      {
-	or_mask <<= 1;
-	xor_mask <<= 1;
-      }
-    } while( len != 0 );
+      if ( u8g2->draw_color <= 1 )
+	*ptr |= mask;
+      if ( u8g2->draw_color != 1 )
+	*ptr ^= mask;
+      ptr+=u8g2->pixel_buf_width;	/* 6 Jan 17: Changed u8g2->width to u8g2->pixel_buf_width, issue #148 */
+      mask = 0xff;
+      rest -= 8;
+    }
+    mask &= 0xff >> (8 - rest);
+#ifdef __unix
+    assert(ptr < max_ptr);
+#endif
+    if ( u8g2->draw_color <= 1 )
+      *ptr |= mask;
+    if ( u8g2->draw_color != 1 )
+      *ptr ^= mask;
   }
 }
 
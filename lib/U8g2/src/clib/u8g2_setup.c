@@ -81,6 +81,7 @@ void u8g2_SetupBuffer(u8g2_t *u8g2, uint8_t *buf, uint8_t tile_buf_height, u8g2_
   u8g2->tile_buf_height = tile_buf_height;
   
   u8g2->tile_curr_row = 0;
+  u8g2->is_gray4 = 0;	/* set by u8g2_SetupBufferGray4() */
   
   u8g2->font_decode.is_transparent = 0; /* issue 443 */
   u8g2->bitmap_transparency = 0;
@@ -291,7 +292,12 @@ void u8g2_update_page_win_r3(u8g2_t *u8g2)
 
 
 /*============================================*/
-extern void u8g2_draw_hv_line_2dir(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir);
+/*
+  The following procedures do the same as u8g2_draw_hv_line_2dir() after
+  the rotation: The y position is transformed into the local buffer and 
+  the low level procedure is called directly. This avoids one more call
+  for each hv line, which is noticeable especially for U8G2_R1..U8G2_R3.
+*/
 
 
 void u8g2_draw_l90_r0(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir)
@@ -299,7 +305,8 @@ void u8g2_draw_l90_r0(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t le
 #ifdef __unix
   assert( dir <= 1 );
 #endif
-  u8g2_draw_hv_line_2dir(u8g2, x, y, len, dir);
+  y -= u8g2->pixel_curr_row;
+  u8g2->ll_hvline(u8g2, x, y, len, dir);
 }
 
 void u8g2_draw_l90_mirrorr_r0(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir)
@@ -315,7 +322,8 @@ void u8g2_draw_l90_mirrorr_r0(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_u
   {
     xx--;
   }
-  u8g2_draw_hv_line_2dir(u8g2, xx, y, len, dir);
+  y -= u8g2->pixel_curr_row;
+  u8g2->ll_hvline(u8g2, xx, y, len, dir);
 }
 
 /* dir = 0 or 1 */
@@ -341,7 +349,8 @@ void u8g2_draw_l90_r1(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t le
     dir = 0;
   }
   
-  u8g2_draw_hv_line_2dir(u8g2, xx, yy, len, dir);
+  yy -= u8g2->pixel_curr_row;
+  u8g2->ll_hvline(u8g2, xx, yy, len, dir);
 }
 
 void u8g2_draw_l90_r2(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir)
@@ -386,7 +395,8 @@ void u8g2_draw_l90_r2(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t le
     yy -= len;
   }
 
-  u8g2_draw_hv_line_2dir(u8g2, xx, yy, len, dir);
+  yy -= u8g2->pixel_curr_row;
+  u8g2->ll_hvline(u8g2, xx, yy, len, dir);
 }
 
 void u8g2_draw_l90_r3(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir)
@@ -412,7 +422,8 @@ void u8g2_draw_l90_r3(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t le
   }
   
   
-  u8g2_draw_hv_line_2dir(u8g2, xx, yy, len, dir);
+  yy -= u8g2->pixel_curr_row;
+  u8g2->ll_hvline(u8g2, xx, yy, len, dir);
 }
 
 
@@ -50,6 +50,31 @@ static uint8_t u8log_is_on_screen(u8log_t *u8log, uint8_t x, uint8_t y)
 }
 */
 
+/*
+  The lines of the screen buffer are used as ring: screen line y is stored 
+  in buffer line (first_line + y) % height. Scrolling just moves first_line.
+*/
+uint8_t *u8log_GetLine(u8log_t *u8log, uint8_t y)
+{
+  uint16_t line = u8log->first_line;
+  line += y;
+  if ( line >= u8log->height )
+    line -= u8log->height;
+  line *= u8log->width;
+  return u8log->screen_buffer + line;
+}
+
+/* mark a line for redraw, lines after 31 are not tracked: redraw all */
+static void u8log_set_dirty(u8log_t *u8log, uint8_t y)
+{
+  if ( y >= u8log->height )
+    return;			/* cursor is below the last line */
+  if ( y < 32 )
+    u8log->dirty_lines |= ((uint32_t)1) << y;
+  else
+    u8log->is_redraw_all = 1;
+}
+
 static void u8log_clear_screen(u8log_t *u8log)
 {
   uint8_t *dest = u8log->screen_buffer;
@@ -60,29 +85,17 @@ static void u8log_clear_screen(u8log_t *u8log)
     *dest++ = ' ';
     cnt--;
   } while( cnt > 0 );
-  
+  u8log->first_line = 0;
 }
 
 
-/* scroll the content of the complete buffer, set redraw_line to 255 */
+/* scroll the content of the complete buffer by one line: clear the top line and make it the bottom line */
 static void u8log_scroll_up(u8log_t *u8log)
 {
-  uint8_t *dest = u8log->screen_buffer;
-  uint8_t *src = dest+u8log->width;
-  uint16_t cnt = u8log->height;
-  cnt--;
-  cnt *= u8log->width;
-  do
-  {
-    *dest++ = *src++;
-    cnt--;
-  } while( cnt > 0 );
-  cnt = u8log->width;
-  do
-  {
-    *dest++ = ' ';
-    cnt--;
-  } while(cnt > 0);
+  memset(u8log_GetLine(u8log, 0), ' ', u8log->width);
+  u8log->first_line++;
+  if ( u8log->first_line >= u8log->height )
+    u8log->first_line = 0;
   
   if ( u8log->is_redraw_line_for_each_char )
     u8log->is_redraw_all = 1;
@@ -114,7 +127,8 @@ static void u8log_cursor_on_screen(u8log_t *u8log)
 static void u8log_write_to_screen(u8log_t *u8log, uint8_t c)
 {
   u8log_cursor_on_screen(u8log);
-  u8log->screen_buffer[u8log->cursor_y * u8log->width + u8log->cursor_x] = c;
+  u8log_GetLine(u8log, u8log->cursor_y)[u8log->cursor_x] = c;
+  u8log_set_dirty(u8log, u8log->cursor_y);
   u8log->cursor_x++;
   
   if ( u8log->is_redraw_line_for_each_char )
@@ -142,6 +156,7 @@ void u8log_write_char(u8log_t *u8log, uint8_t c)
     case '\n':	// 10
       u8log->is_redraw_line = 1;
       u8log->redraw_line = u8log->cursor_y;
+      u8log_set_dirty(u8log, u8log->cursor_y);
       if ( u8log->is_redraw_all_required_for_next_nl )
 	u8log->is_redraw_all = 1;
       u8log->is_redraw_all_required_for_next_nl = 0;
@@ -151,6 +166,7 @@ void u8log_write_char(u8log_t *u8log, uint8_t c)
     case '\r':	// 13
       u8log->is_redraw_line = 1;
       u8log->redraw_line = u8log->cursor_y;
+      u8log_set_dirty(u8log, u8log->cursor_y);
       u8log->cursor_x = 0;
       break;
     case '\t':	// 9
@@ -207,6 +223,7 @@ void u8log_WriteChar(u8log_t *u8log, uint8_t c)
     }
     u8log->is_redraw_line = 0;
     u8log->is_redraw_all = 0;
+    u8log->dirty_lines = 0;
   }
 }
 
@@ -53,15 +53,17 @@ void u8g2_DrawLog(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8log_t *u8log)
   u8g2_uint_t disp_x, disp_y;
   uint8_t buf_x, buf_y;
   uint8_t c;
+  uint8_t *line;
   
   disp_y = y;  
   u8g2_SetFontDirection(u8g2, 0);
   for( buf_y = 0; buf_y < u8log->height; buf_y++ )
   {
     disp_x = x;
+    line = u8log_GetLine(u8log, buf_y);
     for( buf_x = 0; buf_x < u8log->width; buf_x++ )
     {
-      c = u8log->screen_buffer[buf_y * u8log->width + buf_x];
+      c = line[buf_x];
       disp_x += u8g2_DrawGlyph(u8g2, disp_x, disp_y, c);
     }
     disp_y += u8g2_GetAscent(u8g2) - u8g2_GetDescent(u8g2);
@@ -41,9 +41,10 @@ static void u8x8_DrawLogLine(u8x8_t *u8x8, uint8_t disp_x, uint8_t disp_y, uint8
 {
   uint8_t buf_x;
   uint8_t c;
+  uint8_t *line = u8log_GetLine(u8log, buf_y);
   for( buf_x = 0; buf_x < u8log->width; buf_x++ )
   {
-    c = u8log->screen_buffer[buf_y * u8log->width + buf_x];
+    c = line[buf_x];
     u8x8_DrawGlyph(u8x8, disp_x, disp_y, c);
     disp_x++;
   }
@@ -69,7 +70,16 @@ void u8log_u8x8_cb(u8log_t * u8log)
   }
   else if ( u8log->is_redraw_line )
   {
-    u8x8_DrawLogLine(u8x8, 0, u8log->redraw_line, u8log->redraw_line, u8log);
+    /* redraw all lines, which have been changed since the last redraw */
+    uint32_t dirty = u8log->dirty_lines;
+    uint8_t y = 0;
+    while( dirty != 0 )
+    {
+      if ( dirty & 1 )
+	u8x8_DrawLogLine(u8x8, 0, y, y, u8log);
+      dirty >>= 1;
+      y++;
+    }
   }
 }
 
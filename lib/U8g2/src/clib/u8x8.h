@@ -194,6 +194,7 @@ uint8_t u8x8_pgm_read_esp(const uint8_t * addr);   /* u8x8_8x8.c */
 typedef struct u8x8_struct u8x8_t;
 typedef struct u8x8_display_info_struct u8x8_display_info_t;
 typedef struct u8x8_tile_struct u8x8_tile_t;
+typedef struct u8x8_bus_stats_struct u8x8_bus_stats_t;
 
 typedef uint8_t (*u8x8_msg_cb)(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
 typedef uint16_t (*u8x8_char_cb)(u8x8_t *u8x8, uint8_t b);
@@ -346,6 +347,7 @@ struct u8x8_struct
   uint8_t debounce_last_pin_state;
   uint8_t debounce_state;
   uint8_t debounce_result_msg;	/* result msg or event after debounce */
+  u8x8_bus_stats_t *bus_stats;	/* see u8x8_bus_stats.c, NULL if not installed */
 #ifdef U8X8_WITH_USER_PTR
   void *user_ptr;
 #endif
@@ -406,6 +408,8 @@ struct u8log_struct
   /* internal data */
   //uint8_t last_x, last_y;	/* position of the last printed char */
   uint8_t cursor_x, cursor_y;  /* position of the cursor, might be off screen */
+  uint8_t first_line;		/* screen_buffer is a ring of lines: index of the top line */
+  uint32_t dirty_lines;		/* bit n: screen line n has changed, only lines 0..31 */
   uint8_t redraw_line;	/* redraw specific line if is_redraw_line is not 0 */
   uint8_t is_redraw_line;
   uint8_t is_redraw_all;
@@ -516,6 +520,28 @@ void u8x8_d_helper_display_init(u8x8_t *u8g2);
 */
 #define U8X8_MSG_DISPLAY_REFRESH 16
 
+/*
+  Name: 	U8X8_MSG_DISPLAY_DRAW_GRAY4
+  Args:	
+    arg_int: Number of tile rows
+    arg_ptr: pointer to u8x8_tile_t
+        uint8_t *tile_ptr;	pointer to 4 bit per pixel data
+	uint8_t cnt;		width of the area in tiles
+	uint8_t x_pos;		first tile x position
+	uint8_t y_pos;		first tile y position 
+  Tasks:
+    Write an area of cnt x arg_int tiles from a 4 bit per pixel buffer,
+    used by 16 level gray displays (SSD1327). The data is stored row by row,
+    each pixel row has 4*cnt bytes and the left pixel of each byte is in 
+    the upper nibble. This is the layout of the display RAM, so the data
+    is sent without conversion.
+    Display procedures without gray support return 0.
+  Use
+    uint8_t u8x8_DrawGray4(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t cnt, uint8_t rows, uint8_t *ptr)
+  to send the message to the display handler.
+*/
+#define U8X8_MSG_DISPLAY_DRAW_GRAY4 17
+
 /*==========================================*/
 /* u8x8_setup.c */
 
@@ -534,6 +560,7 @@ void u8x8_Setup(u8x8_t *u8x8, u8x8_msg_cb display_cb, u8x8_msg_cb cad_cb, u8x8_m
 /*==========================================*/
 /* u8x8_display.c */
 uint8_t u8x8_DrawTile(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t cnt, uint8_t *tile_ptr);
+uint8_t u8x8_DrawGray4(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t cnt, uint8_t rows, uint8_t *ptr);
 
 /* 
   After a call to u8x8_SetupDefaults, 
@@ -673,6 +700,24 @@ uint8_t u8x8_byte_ssd13xx_sw_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, voi
 uint8_t u8x8_byte_sw_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
 uint8_t u8x8_byte_sed1520(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
 
+/* u8x8_bus_stats.c */
+struct u8x8_bus_stats_struct
+{
+  u8x8_msg_cb byte_cb;		/* the observed byte procedure, may be NULL */
+  uint32_t transfers;		/* number of start/end transfer sequences */
+  uint32_t cmd_bytes;
+  uint32_t data_bytes;
+  uint32_t clocks;		/* clock cycles on the bus, including protocol overhead */
+  uint8_t is_i2c;
+  uint8_t dc;			/* current state of the DC line */
+  uint8_t is_first;		/* i2c: next byte is the control byte */
+};
+
+void u8x8_ClearBusStats(u8x8_t *u8x8);
+void u8x8_InstallBusStats(u8x8_t *u8x8, u8x8_bus_stats_t *stats, uint8_t is_i2c);
+uint8_t u8x8_byte_stats(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
+uint32_t u8x8_GetBusStatsMicros(u8x8_t *u8x8);
+
 
 /*==========================================*/
 /* GPIO Interface */
@@ -931,12 +976,18 @@ void u8x8_SetFont(u8x8_t *u8x8, const uint8_t *font_8x8);
 void u8x8_DrawGlyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding);
 void u8x8_Draw2x2Glyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding);
 void u8x8_Draw1x2Glyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding);
+void u8x8_Draw3x3Glyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding);
+void u8x8_Draw4x4Glyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding);
 uint8_t u8x8_DrawString(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s);
 uint8_t u8x8_DrawUTF8(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s);	/* return number of glyps */
 uint8_t u8x8_Draw2x2String(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s);
 uint8_t u8x8_Draw2x2UTF8(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s);
 uint8_t u8x8_Draw1x2String(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s);
 uint8_t u8x8_Draw1x2UTF8(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s);
+uint8_t u8x8_Draw3x3String(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s);
+uint8_t u8x8_Draw3x3UTF8(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s);
+uint8_t u8x8_Draw4x4String(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s);
+uint8_t u8x8_Draw4x4UTF8(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s);
 uint8_t u8x8_GetUTF8Len(u8x8_t *u8x8, const char *s);
 #define u8x8_SetInverseFont(u8x8, b) (u8x8)->is_font_inverse_mode = (b)
 
@@ -1003,6 +1054,7 @@ void u8log_WriteHex16(u8log_t *u8log, uint16_t v);
 void u8log_WriteHex32(u8log_t *u8log, uint32_t v);
 void u8log_WriteDec8(u8log_t *u8log, uint8_t v, uint8_t d);
 void u8log_WriteDec16(u8log_t *u8log, uint16_t v, uint8_t d);
+uint8_t *u8log_GetLine(u8log_t *u8log, uint8_t y);
 
 /*==========================================*/
 /* u8log_u8x8.c */
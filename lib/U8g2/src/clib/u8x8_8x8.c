@@ -37,6 +37,15 @@
 
 #include "u8x8.h"
 
+/*
+  Number of tiles, which are collected by the string procedures before they
+  are sent with a single u8x8_DrawTile() call. Each tile requires 8 bytes on 
+  the stack (16 bytes for the 2x2 and 1x2 procedures, 32 bytes for 3x3 and 4x4).
+*/
+#ifndef U8X8_STRING_TILE_CNT
+#define U8X8_STRING_TILE_CNT 8
+#endif
+
 #if defined(ESP8266)
 uint8_t u8x8_pgm_read_esp(const uint8_t * addr) 
 {
@@ -102,6 +111,23 @@ static void u8x8_get_glyph_data(u8x8_t *u8x8, uint8_t encoding, uint8_t *buf, ui
   
 }
 
+/*
+  send the cnt tiles at tile_ptr to x, y, but only the tiles left of the 
+  right edge of the display: the runs of tiles collected by the glyph and 
+  string procedures must not extend past the display width, most 
+  controllers would wrap them to the left side of the same page
+*/
+static void u8x8_draw_tile_run(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t cnt, uint8_t *tile_ptr) U8X8_NOINLINE;
+static void u8x8_draw_tile_run(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t cnt, uint8_t *tile_ptr)
+{
+  uint8_t w = u8x8->display_info->tile_width;
+  if ( x >= w )
+    return;
+  if ( cnt > w - x )
+    cnt = w - x;
+  u8x8_DrawTile(u8x8, x, y, cnt, tile_ptr);
+}
+
 void u8x8_DrawGlyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding)
 {
   uint8_t th = u8x8_pgm_read(u8x8->font+2);		/* new 2019 format */
@@ -117,7 +143,7 @@ void u8x8_DrawGlyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding)
     do
     {
       u8x8_get_glyph_data(u8x8, encoding, buf, tile);
-      u8x8_DrawTile(u8x8, xx, y, 1, buf);
+      u8x8_draw_tile_run(u8x8, xx, y, 1, buf);
       tile++;
       xx++;
     } while( xx < th );
@@ -176,7 +202,12 @@ static void u8x8_upscale_buf(uint8_t *src, uint8_t *dest)
   } while( i > 0 );
 }
 
-static void u8x8_draw_2x2_subglyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding, uint8_t tile)
+/* 
+  upscale one tile of a glyph to 2x2 tiles: 
+  upper and lower must point to 16 bytes (two tiles) each
+*/
+static void u8x8_get_2x2_subglyph(u8x8_t *u8x8, uint8_t encoding, uint8_t tile, uint8_t *upper, uint8_t *lower) U8X8_NOINLINE;
+static void u8x8_get_2x2_subglyph(u8x8_t *u8x8, uint8_t encoding, uint8_t tile, uint8_t *upper, uint8_t *lower)
 {
   uint8_t i;
   uint16_t t;
@@ -190,17 +221,19 @@ static void u8x8_draw_2x2_subglyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t e
       buf1[i] = t >> 8;
       buf2[i] = t & 255;
   }
-  u8x8_upscale_buf(buf2, buf);
-  u8x8_DrawTile(u8x8, x, y, 1, buf);
-  
-  u8x8_upscale_buf(buf2+4, buf);
-  u8x8_DrawTile(u8x8, x+1, y, 1, buf);
-  
-  u8x8_upscale_buf(buf1, buf);
-  u8x8_DrawTile(u8x8, x, y+1, 1, buf);
-  
-  u8x8_upscale_buf(buf1+4, buf);
-  u8x8_DrawTile(u8x8, x+1, y+1, 1, buf);  
+  u8x8_upscale_buf(buf2, upper);
+  u8x8_upscale_buf(buf2+4, upper+8);
+  u8x8_upscale_buf(buf1, lower);
+  u8x8_upscale_buf(buf1+4, lower+8);
+}
+
+static void u8x8_draw_2x2_subglyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding, uint8_t tile)
+{
+  uint8_t upper[16];
+  uint8_t lower[16];
+  u8x8_get_2x2_subglyph(u8x8, encoding, tile, upper, lower);
+  u8x8_draw_tile_run(u8x8, x, y, 2, upper);
+  u8x8_draw_tile_run(u8x8, x, y+1, 2, lower);
 }
 
 
@@ -228,22 +261,29 @@ void u8x8_Draw2x2Glyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding)
 }
 
 /* https://github.com/olikraus/u8g2/issues/474 */
-static void u8x8_draw_1x2_subglyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding, uint8_t tile)
+/* upper and lower must point to 8 bytes (one tile) each */
+static void u8x8_get_1x2_subglyph(u8x8_t *u8x8, uint8_t encoding, uint8_t tile, uint8_t *upper, uint8_t *lower) U8X8_NOINLINE;
+static void u8x8_get_1x2_subglyph(u8x8_t *u8x8, uint8_t encoding, uint8_t tile, uint8_t *upper, uint8_t *lower)
 {
   uint8_t i;
   uint16_t t;
   uint8_t buf[8];
-  uint8_t buf1[8];
-  uint8_t buf2[8];
   u8x8_get_glyph_data(u8x8, encoding, buf, tile);
   for( i = 0; i < 8; i ++ )
   {
       t = u8x8_upscale_byte(buf[i]);
-      buf1[i] = t >> 8;
-      buf2[i] = t & 255;
+      lower[i] = t >> 8;
+      upper[i] = t & 255;
   }
-  u8x8_DrawTile(u8x8, x,   y, 1, buf2);
-  u8x8_DrawTile(u8x8, x, y+1, 1, buf1);
+}
+
+static void u8x8_draw_1x2_subglyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding, uint8_t tile)
+{
+  uint8_t upper[8];
+  uint8_t lower[8];
+  u8x8_get_1x2_subglyph(u8x8, encoding, tile, upper, lower);
+  u8x8_draw_tile_run(u8x8, x,   y, 1, upper);
+  u8x8_draw_tile_run(u8x8, x, y+1, 1, lower);
 }
 
 void u8x8_Draw1x2Glyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding)
@@ -268,6 +308,112 @@ void u8x8_Draw1x2Glyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding)
   } while( y < tv );  
 }
 
+/*
+  3x3 and 4x4 upscaling
+
+  Each source byte (one column of 8 pixel) is spread to n*8 bits with a 
+  table lookup per nibble (3x) or per bit pair (4x), instead of the 
+  shift/mask sequence of u8x8_upscale_byte(). All 8 columns of a tile are 
+  converted in one step and written as n rows of n tiles, so that each row
+  can be sent with a single u8x8_DrawTile() call.
+*/
+
+/* 3x: 12 bit result for a nibble, lower and upper byte */
+static const uint8_t u8x8_upscale3_lo[16] U8X8_PROGMEM = 
+  { 0x00, 0x07, 0x38, 0x3f, 0xc0, 0xc7, 0xf8, 0xff, 0x00, 0x07, 0x38, 0x3f, 0xc0, 0xc7, 0xf8, 0xff };
+static const uint8_t u8x8_upscale3_hi[16] U8X8_PROGMEM = 
+  { 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x0e, 0x0e, 0x0e, 0x0e, 0x0f, 0x0f, 0x0f, 0x0f };
+/* 4x: 8 bit result for a bit pair */
+static const uint8_t u8x8_upscale4[4] U8X8_PROGMEM = { 0x00, 0x0f, 0xf0, 0xff };
+
+static uint16_t u8x8_upscale3_nibble(uint8_t x)
+{
+  uint16_t y = u8x8_pgm_read(u8x8_upscale3_hi+x);
+  y <<= 8;
+  y |= u8x8_pgm_read(u8x8_upscale3_lo+x);
+  return y;
+}
+
+/* 
+  upscale one tile of a glyph to nxn tiles (n is 3 or 4):
+  dest must point to n rows of n*8 bytes (n tiles), row i starts at dest + i*stride
+*/
+static void u8x8_get_nxn_subglyph(u8x8_t *u8x8, uint8_t encoding, uint8_t tile, uint8_t n, uint8_t *dest, uint8_t stride) U8X8_NOINLINE;
+static void u8x8_get_nxn_subglyph(u8x8_t *u8x8, uint8_t encoding, uint8_t tile, uint8_t n, uint8_t *dest, uint8_t stride)
+{
+  uint8_t i, j, k, b;
+  uint32_t t;
+  uint8_t buf[8];
+  uint8_t *d;
+  u8x8_get_glyph_data(u8x8, encoding, buf, tile);
+  for( i = 0; i < 8; i++ )
+  {
+    if ( n == 3 )
+    {
+      t = u8x8_upscale3_nibble(buf[i] >> 4);
+      t <<= 12;
+      t |= u8x8_upscale3_nibble(buf[i] & 15);
+    }
+    else
+    {
+      t = u8x8_pgm_read(u8x8_upscale4+(buf[i] >> 6));
+      t <<= 8;
+      t |= u8x8_pgm_read(u8x8_upscale4+((buf[i] >> 4) & 3));
+      t <<= 8;
+      t |= u8x8_pgm_read(u8x8_upscale4+((buf[i] >> 2) & 3));
+      t <<= 8;
+      t |= u8x8_pgm_read(u8x8_upscale4+(buf[i] & 3));
+    }
+    /* column i of the source becomes n equal columns in each of the n rows */
+    d = dest + i*n;
+    for( j = 0; j < n; j++ )
+    {
+      b = t & 255;
+      t >>= 8;
+      for( k = 0; k < n; k++ )
+	d[k] = b;
+      d += stride;
+    }
+  }
+}
+
+static void u8x8_draw_nxn_glyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding, uint8_t n) U8X8_NOINLINE;
+static void u8x8_draw_nxn_glyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding, uint8_t n)
+{
+  uint8_t th = u8x8_pgm_read(u8x8->font+2);		/* new 2019 format */
+  uint8_t tv = u8x8_pgm_read(u8x8->font+3);	/* new 2019 format */
+  uint8_t xx, tile, i;
+  uint8_t buf[4*4*8];
+  th *= n;
+  th += x;
+  tv *= n;
+  tv += y;
+  tile = 0;
+  do
+  {
+    xx = x;
+    do
+    {
+      u8x8_get_nxn_subglyph(u8x8, encoding, tile, n, buf, n*8);
+      for( i = 0; i < n; i++ )
+	u8x8_draw_tile_run(u8x8, xx, y+i, n, buf+i*n*8);
+      tile++;
+      xx+=n;
+    } while( xx < th );
+    y+=n;
+  } while( y < tv );  
+}
+
+void u8x8_Draw3x3Glyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding)
+{
+  u8x8_draw_nxn_glyph(u8x8, x, y, encoding, 3);
+}
+
+void u8x8_Draw4x4Glyph(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding)
+{
+  u8x8_draw_nxn_glyph(u8x8, x, y, encoding, 4);
+}
+
 /*
 source: https://en.wikipedia.org/wiki/UTF-8
 Bits	from 		to			bytes	Byte 1 		Byte 2 		Byte 3 		Byte 4 		Byte 5 		Byte 6
@@ -356,11 +502,20 @@ uint16_t u8x8_utf8_next(u8x8_t *u8x8, uint8_t b)
 
 
 static uint8_t u8x8_draw_string(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s) U8X8_NOINLINE;
+/* returns 1 if the glyphs of the current font have only one tile */
+static uint8_t u8x8_is_single_tile_font(u8x8_t *u8x8)
+{
+  return u8x8_pgm_read(u8x8->font+2) == 1 && u8x8_pgm_read(u8x8->font+3) == 1;
+}
+
 static uint8_t u8x8_draw_string(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s)
 {
   uint16_t e;
   uint8_t cnt = 0;
   uint8_t th = u8x8_pgm_read(u8x8->font+2);		/* new 2019 format */
+  uint8_t buf[U8X8_STRING_TILE_CNT*8];
+  uint8_t n = 0;
+  uint8_t is_single_tile = u8x8_is_single_tile_font(u8x8);
 
   u8x8_utf8_init(u8x8);
   for(;;)
@@ -371,11 +526,28 @@ static uint8_t u8x8_draw_string(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *
     s++;
     if ( e != 0x0fffe )
     {
-      u8x8_DrawGlyph(u8x8, x, y, e);
-      x+=th;
+      if ( is_single_tile )
+      {
+	/* collect the tiles and send them together */
+	u8x8_get_glyph_data(u8x8, e, buf+n*8, 0);
+	n++;
+	if ( n == U8X8_STRING_TILE_CNT )
+	{
+	  u8x8_draw_tile_run(u8x8, x, y, n, buf);
+	  x += n;
+	  n = 0;
+	}
+      }
+      else
+      {
+	u8x8_DrawGlyph(u8x8, x, y, e);
+	x+=th;
+      }
       cnt++;
     }
   }
+  if ( n > 0 )
+    u8x8_draw_tile_run(u8x8, x, y, n, buf);
   return cnt;
 }
 
@@ -399,6 +571,11 @@ static uint8_t u8x8_draw_2x2_string(u8x8_t *u8x8, uint8_t x, uint8_t y, const ch
 {
   uint16_t e;
   uint8_t cnt = 0;
+  uint8_t upper[U8X8_STRING_TILE_CNT*8];
+  uint8_t lower[U8X8_STRING_TILE_CNT*8];
+  uint8_t n = 0;		/* number of collected tiles in upper and lower */
+  uint8_t is_single_tile = u8x8_is_single_tile_font(u8x8);
+  
   u8x8_utf8_init(u8x8);
   for(;;)
   {
@@ -408,11 +585,32 @@ static uint8_t u8x8_draw_2x2_string(u8x8_t *u8x8, uint8_t x, uint8_t y, const ch
     s++;
     if ( e != 0x0fffe )
     {
-      u8x8_Draw2x2Glyph(u8x8, x, y, e);
-      x+=2;
+      if ( is_single_tile )
+      {
+	/* collect the upscaled tiles and send them as one upper and one lower row */
+	if ( n+2 > U8X8_STRING_TILE_CNT )
+	{
+	  u8x8_draw_tile_run(u8x8, x, y, n, upper);
+	  u8x8_draw_tile_run(u8x8, x, y+1, n, lower);
+	  x += n;
+	  n = 0;
+	}
+	u8x8_get_2x2_subglyph(u8x8, e, 0, upper+n*8, lower+n*8);
+	n+=2;
+      }
+      else
+      {
+	u8x8_Draw2x2Glyph(u8x8, x, y, e);
+	x+=2;
+      }
       cnt++;
     }
   }
+  if ( n > 0 )
+  {
+    u8x8_draw_tile_run(u8x8, x, y, n, upper);
+    u8x8_draw_tile_run(u8x8, x, y+1, n, lower);
+  }
   return cnt;
 }
 
@@ -436,6 +634,11 @@ static uint8_t u8x8_draw_1x2_string(u8x8_t *u8x8, uint8_t x, uint8_t y, const ch
 {
   uint16_t e;
   uint8_t cnt = 0;
+  uint8_t upper[U8X8_STRING_TILE_CNT*8];
+  uint8_t lower[U8X8_STRING_TILE_CNT*8];
+  uint8_t n = 0;		/* number of collected tiles in upper and lower */
+  uint8_t is_single_tile = u8x8_is_single_tile_font(u8x8);
+  
   u8x8_utf8_init(u8x8);
   for(;;)
   {
@@ -445,11 +648,31 @@ static uint8_t u8x8_draw_1x2_string(u8x8_t *u8x8, uint8_t x, uint8_t y, const ch
     s++;
     if ( e != 0x0fffe )
     {
-      u8x8_Draw1x2Glyph(u8x8, x, y, e);
-      x++;
+      if ( is_single_tile )
+      {
+	u8x8_get_1x2_subglyph(u8x8, e, 0, upper+n*8, lower+n*8);
+	n++;
+	if ( n == U8X8_STRING_TILE_CNT )
+	{
+	  u8x8_draw_tile_run(u8x8, x, y, n, upper);
+	  u8x8_draw_tile_run(u8x8, x, y+1, n, lower);
+	  x += n;
+	  n = 0;
+	}
+      }
+      else
+      {
+	u8x8_Draw1x2Glyph(u8x8, x, y, e);
+	x++;
+      }
       cnt++;
     }
   }
+  if ( n > 0 )
+  {
+    u8x8_draw_tile_run(u8x8, x, y, n, upper);
+    u8x8_draw_tile_run(u8x8, x, y+1, n, lower);
+  }
   return cnt;
 }
 
@@ -467,6 +690,80 @@ uint8_t u8x8_Draw1x2UTF8(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s)
 }
 
 
+static uint8_t u8x8_draw_nxn_string(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s, uint8_t n) U8X8_NOINLINE;
+static uint8_t u8x8_draw_nxn_string(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s, uint8_t n)
+{
+  uint16_t e;
+  uint8_t cnt = 0;
+  uint8_t th = u8x8_pgm_read(u8x8->font+2);		/* new 2019 format */
+  uint8_t rows[4*U8X8_STRING_TILE_CNT*8];	/* n rows of U8X8_STRING_TILE_CNT tiles */
+  uint8_t m = 0;		/* number of collected tiles in each row */
+  uint8_t i;
+  uint8_t is_single_tile = u8x8_is_single_tile_font(u8x8) && n <= U8X8_STRING_TILE_CNT;
+  
+  u8x8_utf8_init(u8x8);
+  for(;;)
+  {
+    e = u8x8->next_cb(u8x8, (uint8_t)*s);
+    if ( e == 0x0ffff )
+      break;
+    s++;
+    if ( e != 0x0fffe )
+    {
+      if ( is_single_tile )
+      {
+	if ( m+n > U8X8_STRING_TILE_CNT )
+	{
+	  for( i = 0; i < n; i++ )
+	    u8x8_draw_tile_run(u8x8, x, y+i, m, rows+i*U8X8_STRING_TILE_CNT*8);
+	  x += m;
+	  m = 0;
+	}
+	u8x8_get_nxn_subglyph(u8x8, e, 0, n, rows+m*8, U8X8_STRING_TILE_CNT*8);
+	m+=n;
+      }
+      else
+      {
+	u8x8_draw_nxn_glyph(u8x8, x, y, e, n);
+	x+=th*n;
+      }
+      cnt++;
+    }
+  }
+  if ( m > 0 )
+  {
+    for( i = 0; i < n; i++ )
+      u8x8_draw_tile_run(u8x8, x, y+i, m, rows+i*U8X8_STRING_TILE_CNT*8);
+  }
+  return cnt;
+}
+
+
+uint8_t u8x8_Draw3x3String(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s)
+{
+  u8x8->next_cb = u8x8_ascii_next;
+  return u8x8_draw_nxn_string(u8x8, x, y, s, 3);
+}
+
+uint8_t u8x8_Draw3x3UTF8(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s)
+{
+  u8x8->next_cb = u8x8_utf8_next;
+  return u8x8_draw_nxn_string(u8x8, x, y, s, 3);
+}
+
+uint8_t u8x8_Draw4x4String(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s)
+{
+  u8x8->next_cb = u8x8_ascii_next;
+  return u8x8_draw_nxn_string(u8x8, x, y, s, 4);
+}
+
+uint8_t u8x8_Draw4x4UTF8(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s)
+{
+  u8x8->next_cb = u8x8_utf8_next;
+  return u8x8_draw_nxn_string(u8x8, x, y, s, 4);
+}
+
+
 
 uint8_t u8x8_GetUTF8Len(u8x8_t *u8x8, const char *s)
 {
@@ -0,0 +1,175 @@
+/*
+
+  u8x8_bus_stats.c
+
+  Transfer statistics and bus time estimation for the byte interface
+
+  Universal 8bit Graphics Library (https://github.com/olikraus/u8g2/)
+
+  Copyright (c) 2016, olikraus@gmail.com
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, 
+  are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this list 
+    of conditions and the following disclaimer.
+    
+  * Redistributions in binary form must reproduce the above copyright notice, this 
+    list of conditions and the following disclaimer in the documentation and/or other 
+    materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND 
+  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR 
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  
+
+*/
+
+/*
+  Bus statistics: u8x8_byte_stats is placed between the cad layer and 
+  the byte procedure of the display. It counts the transfers, command and 
+  data bytes and the number of clock cycles on the bus. Together with the 
+  bus clock this gives an estimation of the time, which is required to 
+  transfer a frame to the display. 
+  
+  The byte procedure can be the hardware procedure or u8x8_byte_empty. 
+  With u8x8_byte_empty, the transfer time can be estimated without 
+  display, e.g. to compare different cad procedures or chunk sizes.
+  
+    static u8x8_bus_stats_t stats;
+    u8x8_InstallBusStats(u8g2_GetU8x8(&u8g2), &stats, 1);
+    ...
+    u8x8_ClearBusStats(u8g2_GetU8x8(&u8g2));
+    u8g2_SendBuffer(&u8g2);
+    t = u8x8_GetBusStatsMicros(u8g2_GetU8x8(&u8g2));
+  
+  Timing model:
+    I2C: start condition and address byte (10 clocks) per transfer, 
+      9 clocks per byte (8 bits + ACK), stop condition (1 clock).
+      The first byte of each transfer is the control byte of the
+      SSD13xx/SH11xx controllers, it is counted as protocol overhead 
+      and decides whether the following bytes are command or data bytes.
+    SPI: 8 clocks per byte, command and data bytes are separated by 
+      the DC line.
+      
+  The statistics are stored in the struct given to u8x8_InstallBusStats,
+  u8x8->bus_stats points to it. Each display needs its own struct.
+*/
+
+#include "u8x8.h"
+
+void u8x8_ClearBusStats(u8x8_t *u8x8)
+{
+  u8x8_bus_stats_t *stats = u8x8->bus_stats;
+  if ( stats == NULL )
+    return;
+  stats->transfers = 0;
+  stats->cmd_bytes = 0;
+  stats->data_bytes = 0;
+  stats->clocks = 0;
+}
+
+/*
+  Replace the byte procedure of the display by u8x8_byte_stats. The 
+  original byte procedure is still called for all messages.
+  stats: statistics of this display, must stay valid while installed
+  is_i2c: 1 for I2C displays, 0 for SPI and parallel displays
+*/
+void u8x8_InstallBusStats(u8x8_t *u8x8, u8x8_bus_stats_t *stats, uint8_t is_i2c)
+{
+  if ( u8x8->byte_cb != u8x8_byte_stats )
+    stats->byte_cb = u8x8->byte_cb;
+  else if ( u8x8->bus_stats != stats )
+    stats->byte_cb = u8x8->bus_stats->byte_cb;
+  u8x8->byte_cb = u8x8_byte_stats;
+  u8x8->bus_stats = stats;
+  stats->is_i2c = is_i2c;
+  stats->dc = 0;
+  stats->is_first = 0;
+  u8x8_ClearBusStats(u8x8);
+}
+
+uint8_t u8x8_byte_stats(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr)
+{
+  u8x8_bus_stats_t *stats = u8x8->bus_stats;
+  uint8_t *data;
+  uint8_t cnt;
+  
+  switch(msg)
+  {
+    case U8X8_MSG_BYTE_SEND:
+      data = (uint8_t *)arg_ptr;
+      cnt = arg_int;
+      if ( stats->is_i2c )
+      {
+	stats->clocks += (uint32_t)cnt * 9;
+	if ( stats->is_first != 0 && cnt > 0 )
+	{
+	  /* control byte: Co=0, D/C# is bit 6 */
+	  stats->dc = (*data & 0x40) != 0 ? 1 : 0;
+	  stats->is_first = 0;
+	  cnt--;
+	}
+      }
+      else
+      {
+	stats->clocks += (uint32_t)cnt * 8;
+      }
+      if ( stats->dc )
+	stats->data_bytes += cnt;
+      else
+	stats->cmd_bytes += cnt;
+      break;
+    case U8X8_MSG_BYTE_SET_DC:
+      stats->dc = arg_int;
+      break;
+    case U8X8_MSG_BYTE_START_TRANSFER:
+      stats->transfers++;
+      stats->is_first = 1;
+      if ( stats->is_i2c )
+	stats->clocks += 10;
+      break;
+    case U8X8_MSG_BYTE_END_TRANSFER:
+      if ( stats->is_i2c )
+	stats->clocks += 1;
+      break;
+  }
+  if ( stats->byte_cb == NULL )
+    return 1;
+  return stats->byte_cb(u8x8, msg, arg_int, arg_ptr);
+}
+
+/*
+  Estimated transfer time in microseconds since the last call to 
+  u8x8_ClearBusStats(). The bus clock is u8x8->bus_clock, if this is 
+  not yet assigned, the default clock of the display is used.
+  Returns 0 if no statistics are installed.
+*/
+uint32_t u8x8_GetBusStatsMicros(u8x8_t *u8x8)
+{
+  u8x8_bus_stats_t *stats = u8x8->bus_stats;
+  uint32_t clock = u8x8->bus_clock;
+  if ( stats == NULL )
+    return 0;
+  if ( clock == 0 )
+  {
+    if ( stats->is_i2c )
+      clock = u8x8->display_info->i2c_bus_clock_100kHz * 100000UL;
+    else
+      clock = u8x8->display_info->sck_clock_hz;
+  }
+  if ( clock == 0 )
+    return 0;
+  /* clocks * 1000000 / clock without overflow for large frames */
+  return (uint32_t)(((uint64_t)stats->clocks * 1000000UL) / clock);
+}
@@ -0,0 +1,165 @@
+/*
+
+  u8x8_capture.c
+
+  Screen capture of the u8g2 buffer as PBM (portable bitmap) file
+
+  Universal 8bit Graphics Library (https://github.com/olikraus/u8g2/)
+
+  Copyright (c) 2016, olikraus@gmail.com
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, 
+  are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this list 
+    of conditions and the following disclaimer.
+    
+  * Redistributions in binary form must reproduce the above copyright notice, this 
+    list of conditions and the following disclaimer in the documentation and/or other 
+    materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND 
+  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR 
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  
+
+*/
+
+/*
+  Screen capture: Write the content of the u8g2 tile buffer as 
+  plain PBM ("P1") image. The output is passed in small pieces to the 
+  out procedure, which may write to a file, serial line, etc.
+  
+  For a full frame buffer (_f setup procedures) the complete display is 
+  written. For a page buffer only the current page is written.
+  A gray buffer (_g4 setup procedures) is written as plain PGM ("P2") 
+  image with 16 levels. A row of pixels is broken into several lines 
+  of at most 70 characters, as required for plain PBM and PGM files.
+  
+  Together with the memory-only callbacks u8x8_byte_empty and 
+  u8x8_dummy_cb (as gpio_and_delay_cb), any display setup procedure can be 
+  used without hardware, e.g. to render on a host and compare or 
+  benchmark the result:
+  
+    u8g2_Setup_ssd1327_ea_w128128_f(&u8g2, U8G2_R0, u8x8_byte_empty, u8x8_dummy_cb);
+    u8g2_InitDisplay(&u8g2);
+    ...
+    u8g2_SendBuffer(&u8g2);
+    u8g2_WriteBufferPBM(&u8g2, out);
+
+  The host build (CMakeLists.txt of the project) does this in 
+  test/u8g2_bench.c, option -p writes the PBM files.
+*/
+
+#include "u8g2.h"
+#include <string.h>
+
+static const char *u8x8_capture_u16toa(uint16_t v)
+{
+  uint8_t d = 1;
+  uint32_t c = 10;
+  while( c <= v )
+  {
+    d++;
+    c *= 10;
+  }
+  return u8x8_u16toa(v, d);
+}
+
+/* returns 1 if the pixel at x/y of the tile buffer is set, the gray level in gray mode */
+static uint8_t u8g2_capture_get_pixel(u8g2_t *u8g2, uint16_t x, uint16_t y)
+{
+  uint8_t *ptr = u8g2_GetBufferPtr(u8g2);
+  uint16_t tile_width = u8g2_GetBufferTileWidth(u8g2);
+  
+  if ( u8g2->ll_hvline == u8g2_ll_hvline_horizontal_right_lsb )
+  {
+    ptr += y * tile_width;
+    ptr += x >> 3;
+    return (*ptr >> (7 - (x & 7))) & 1;
+  }
+  
+  if ( u8g2->is_gray4 )
+  {
+    ptr += y * tile_width * 4;
+    ptr += x >> 1;
+    if ( x & 1 )
+      return *ptr & 15;
+    return *ptr >> 4;
+  }
+  
+  /* u8g2_ll_hvline_vertical_top_lsb */
+  ptr += (y >> 3) * tile_width * 8;
+  ptr += x;
+  return (*ptr >> (y & 7)) & 1;
+}
+
+/* PBM and PGM lines must not be longer than 70 characters */
+#define U8X8_CAPTURE_LINE_LEN 70
+
+/* 
+  Writes one pixel value. P1 values need no separator, P2 values are 
+  separated by a space or by the line break, which keeps the lines short.
+*/
+static void u8x8_capture_pixel(void (*out)(const char *s), uint8_t *col, const char *s, uint8_t is_first, uint8_t is_gray4)
+{
+  uint8_t len = strlen(s);
+  uint8_t sep = (is_gray4 && !is_first) ? 1 : 0;
+  
+  if ( *col + sep + len > U8X8_CAPTURE_LINE_LEN )
+  {
+    out("\n");
+    *col = 0;
+    sep = 0;
+  }
+  if ( sep )
+  {
+    out(" ");
+    (*col)++;
+  }
+  out(s);
+  *col += len;
+}
+
+void u8g2_WriteBufferPBM(u8g2_t *u8g2, void (*out)(const char *s))
+{
+  uint16_t x, y;
+  uint16_t w, h;
+  uint8_t col;
+  
+  w = u8g2_GetBufferTileWidth(u8g2);
+  w *= 8;
+  h = u8g2_GetBufferTileHeight(u8g2);
+  h *= 8;
+  
+  out(u8g2->is_gray4 ? "P2\n" : "P1\n");
+  out(u8x8_capture_u16toa(w));
+  out(" ");
+  out(u8x8_capture_u16toa(h));
+  out("\n");
+  if ( u8g2->is_gray4 )
+    out("15\n");
+  
+  for( y = 0; y < h; y++ )
+  {
+    col = 0;
+    for( x = 0; x < w; x++ )
+    {
+      if ( u8g2->is_gray4 )
+	u8x8_capture_pixel(out, &col, u8x8_capture_u16toa(u8g2_capture_get_pixel(u8g2, x, y)), x == 0, 1);
+      else
+	u8x8_capture_pixel(out, &col, u8g2_capture_get_pixel(u8g2, x, y) ? "1" : "0", x == 0, 0);
+    }
+    out("\n");
+  }
+}
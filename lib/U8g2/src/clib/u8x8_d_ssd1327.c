@@ -100,6 +100,7 @@ static uint8_t u8x8_d_ssd1327_96x96_generic(u8x8_t *u8x8, uint8_t msg, uint8_t a
 {
   uint8_t x, y, c;
   uint8_t *ptr;
+  uint16_t len;
   switch(msg)
   {
     /* handled by the calling function
@@ -163,6 +164,39 @@ static uint8_t u8x8_d_ssd1327_96x96_generic(u8x8_t *u8x8, uint8_t msg, uint8_t a
 	arg_int--;
       } while( arg_int > 0 );
       
+      u8x8_cad_EndTransfer(u8x8);
+      break;
+    case U8X8_MSG_DISPLAY_DRAW_GRAY4:
+      /* the data has the layout of the display RAM: set the window once and stream all bytes */
+      u8x8_cad_StartTransfer(u8x8);
+      x = ((u8x8_tile_t *)arg_ptr)->x_pos;    
+      x *= 4;
+      x+=u8x8->x_offset/2;
+      c = ((u8x8_tile_t *)arg_ptr)->cnt;
+      c *= 4;		/* bytes per pixel row */
+      y = (((u8x8_tile_t *)arg_ptr)->y_pos);
+      y *= 8;
+    
+      u8x8_cad_SendCmd(u8x8, 0x075 );	/* set row address */
+      u8x8_cad_SendArg(u8x8, y);
+      u8x8_cad_SendArg(u8x8, y+arg_int*8-1);
+      u8x8_cad_SendCmd(u8x8, 0x015 );	/* set column address */
+      u8x8_cad_SendArg(u8x8, x );	/* start */
+      u8x8_cad_SendArg(u8x8, x+c-1 );	/* end */
+      
+      ptr = ((u8x8_tile_t *)arg_ptr)->tile_ptr;
+      len = c;
+      len *= arg_int;
+      len *= 8;
+      while( len > 0 )
+      {
+	/* 240 is a multiple of 24, the maximum data size of one I2C transfer (see u8x8_cad_ssd13xx_i2c) */
+	c = len > 240 ? 240 : len;
+	u8x8_cad_SendData(u8x8, c, ptr);
+	ptr += c;
+	len -= c;
+      }
+      
       u8x8_cad_EndTransfer(u8x8);
       break;
     default:
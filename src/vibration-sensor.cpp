@@ -9,13 +9,33 @@ SYSTEM_THREAD(ENABLED);
 
 // Show system, cloud connectivity, and application logs over USB
 // View logs with CLI using 'particle serial monitor --follow'
-SerialLogHandler logHandler(LOG_LEVEL_INFO);
+// Binary output to Serial (the trace dump) holds serialLock(): log messages of
+// all threads are dropped meanwhile instead of being mixed into the data.
+#include <mutex>
+class SharedSerialLogHandler : public SerialLogHandler {
+  private:
+    std::mutex lock;
+  public:
+    SharedSerialLogHandler(LogLevel level) : SerialLogHandler(level) {}
+    std::mutex& serialLock() {
+      return lock;
+    }
+  protected:
+    void write(const char* data, size_t size) override {
+      std::unique_lock<std::mutex> guard(lock, std::try_to_lock);
+      if (guard.owns_lock()) {
+        SerialLogHandler::write(data, size);
+      }
+    }
+};
+SharedSerialLogHandler logHandler(LOG_LEVEL_INFO);
 
 class JSonizer {
   public:
     static void addFirstSetting(String& json, String key, String val);
     static void addSetting(String& json, String key, String val);
     static String toString(bool b);
+    static String toString(uint64_t v);
 };
 
 void JSonizer::addFirstSetting(String& json, String key, String val) {
@@ -43,37 +63,351 @@ String JSonizer::toString(bool b) {
     return "false";
 }
 
+String JSonizer::toString(uint64_t v) {
+    char s[21];
+    char* p = s + sizeof(s) - 1;
+    *p = '\0';
+    do {
+      *--p = '0' + v % 10;
+      v /= 10;
+    } while (v != 0);
+    return String(p);
+}
+
+// millis() and micros() extended to 64 bits, so that time differences stay
+// valid across the 32 bit wrap (~49.7 days for millis(), ~71.6 minutes for
+// micros()). millis64() is the 64 bit System.millis() of Device OS. micros64()
+// takes the wraps from it: micros() read just after System.millis() is less than
+// a millisecond ahead of System.millis() * 1000, so their signed 32 bit
+// difference gives the exact value. No state, no need to call them regularly.
+class Clock {
+  public:
+    static uint64_t millis64() {
+      return System.millis();
+    }
+    static uint64_t micros64() {
+      uint64_t reference = millis64() * 1000;
+      uint32_t m = micros();
+      return reference + (int32_t)(m - (uint32_t)reference);
+    }
+};
+
+// Comment out to remove the profiling counters (and the "perf" setting) completely.
+#define PERF_COUNTERS
+
+#ifdef PERF_COUNTERS
+// Execution time of one code section, measured with the cycle counter.
+// Updating is a few integer operations: no allocation, no locking.
+class PerfSection {
+  public:
+    static const int NUM_BUCKETS = 16;  // bucket i counts times in [2^(i-1), 2^i) us
+
+    const char* name;
+    uint32_t    count = 0;
+    uint32_t    minTicks = UINT32_MAX;
+    uint32_t    maxTicks = 0;
+    uint64_t    totalTicks = 0;
+    uint32_t    buckets[NUM_BUCKETS] = {};
+
+    PerfSection(const char* n) : name(n) {}
+    void add(uint32_t ticks) {
+      count++;
+      totalTicks += ticks;
+      if (ticks < minTicks) {
+        minTicks = ticks;
+      }
+      if (ticks > maxTicks) {
+        maxTicks = ticks;
+      }
+      uint32_t us = ticks / System.ticksPerMicrosecond();
+      int bucket = (us == 0) ? 0 : 32 - __builtin_clz(us);
+      if (bucket >= NUM_BUCKETS) {
+        bucket = NUM_BUCKETS - 1;
+      }
+      buckets[bucket]++;
+    }
+    String getJson() {
+      uint32_t tpu = System.ticksPerMicrosecond();
+      String hist;
+      int last = NUM_BUCKETS - 1;
+      while (last > 0 && buckets[last] == 0) {
+        last--;
+      }
+      for (int i = 0; i <= last; i++) {
+        if (i > 0) {
+          hist.concat(",");
+        }
+        hist.concat(String(buckets[i]));
+      }
+      String json("{");
+      JSonizer::addFirstSetting(json, "n", String(count));
+      JSonizer::addSetting(json, "minUs", String(count ? minTicks / tpu : 0));
+      JSonizer::addSetting(json, "maxUs", String(maxTicks / tpu));
+      JSonizer::addSetting(json, "meanUs", JSonizer::toString(count ? totalTicks / count / tpu : 0));
+      JSonizer::addSetting(json, "log2Us", hist);
+      json.concat("}");
+      return json;
+    }
+};
+
+class PerfScope {
+  private:
+    PerfSection& section;
+    uint32_t     start;
+  public:
+    PerfScope(PerfSection& s) : section(s), start(System.ticks()) {}
+    ~PerfScope() {
+      section.add(System.ticks() - start);
+    }
+};
+
+class Perf {
+  public:
+    static PerfSection loop;
+    static PerfSection getVoltages;
+    static PerfSection publishMax;
+    static PerfSection display;
+
+    static void publishJson() {
+      String json("{");
+      JSonizer::addFirstSetting(json, loop.name, loop.getJson());
+      JSonizer::addSetting(json, getVoltages.name, getVoltages.getJson());
+      JSonizer::addSetting(json, publishMax.name, publishMax.getJson());
+      JSonizer::addSetting(json, display.name, display.getJson());
+      json.concat("}");
+      Particle.publish("Perf json", json);
+    }
+};
+
+PerfSection Perf::loop("loop");
+PerfSection Perf::getVoltages("getVoltages");
+PerfSection Perf::publishMax("publish_max");
+PerfSection Perf::display("render");
+
+#define PERF_SCOPE(section) PerfScope perfScope_(Perf::section)
+#else
+#define PERF_SCOPE(section)
+#endif
+
+// Comment out to remove the event trace (and the "trace" setting) completely.
+#define TRACE_EVENTS
+
+#ifdef TRACE_EVENTS
+// Ring of begin/end events with micros() timestamps. Recording an event is a
+// store of 8 bytes, the ring keeps the last TRACE_SIZE events. The dump is
+// binary and written to USB serial, convert it with tools/trace_to_chrome.py:
+//   "TRC2", uint8 number of names, NUL-terminated names (index = event id),
+//   uint32 number of events, events: uint32 micros, uint16 id, uint16 phase,
+//   trailer: uint32 number of bytes from "TRC2" up to the trailer, uint32 CRC-32
+//   (zlib) of these bytes, so that the tool can reject a damaged dump.
+// All numbers are little endian.
+class Trace {
+  public:
+    enum Id : uint16_t { SAMPLE, PUBLISH, DISPLAY_FLUSH, TIME_SYNC, NUM_IDS };
+    enum Phase : uint16_t { BEGIN, END };
+  private:
+    struct Event {
+      uint32_t us;
+      uint16_t id;
+      uint16_t phase;
+    };
+    static const uint32_t TRACE_SIZE = 256;   // must be a power of 2
+    static Event    events[TRACE_SIZE];
+    static uint32_t head;
+
+    // Passes the bytes on and keeps their count and CRC-32 for the trailer.
+    class ChecksumPrint : public Print {
+      private:
+        Print& out;
+      public:
+        uint32_t length = 0;
+        uint32_t crc = 0xFFFFFFFF;
+        ChecksumPrint(Print& o) : out(o) {}
+        size_t write(uint8_t c) override {
+          return write(&c, 1);
+        }
+        size_t write(const uint8_t* data, size_t size) override {
+          for (size_t i = 0; i < size; i++) {
+            crc ^= data[i];
+            for (int bit = 0; bit < 8; bit++) {
+              crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+            }
+          }
+          length += size;
+          return out.write(data, size);
+        }
+    };
+  public:
+    static void add(Id id, Phase phase) {
+      Event& e = events[head++ & (TRACE_SIZE - 1)];
+      e.us = micros();
+      e.id = id;
+      e.phase = phase;
+    }
+    static void dump(Print& dest) {
+      static const char* const NAMES[NUM_IDS] = { "sample", "publish", "display flush", "time sync" };
+      ChecksumPrint out(dest);
+      uint32_t n = head < TRACE_SIZE ? head : TRACE_SIZE;
+      out.write((const uint8_t*)"TRC2", 4);
+      out.write((uint8_t)NUM_IDS);
+      for (int i = 0; i < NUM_IDS; i++) {
+        out.write((const uint8_t*)NAMES[i], strlen(NAMES[i]) + 1);
+      }
+      out.write((const uint8_t*)&n, sizeof(n));
+      for (uint32_t i = head - n; i != head; i++) {
+        out.write((const uint8_t*)&events[i & (TRACE_SIZE - 1)], sizeof(Event));
+      }
+      uint32_t trailer[2] = { out.length, ~out.crc };
+      dest.write((const uint8_t*)trailer, sizeof(trailer));
+    }
+};
+
+Trace::Event Trace::events[Trace::TRACE_SIZE];
+uint32_t     Trace::head = 0;
+
+class TraceScope {
+  private:
+    Trace::Id id;
+  public:
+    TraceScope(Trace::Id i) : id(i) { Trace::add(id, Trace::BEGIN); }
+    ~TraceScope() { Trace::add(id, Trace::END); }
+};
+
+#define TRACE_SCOPE(id) TraceScope traceScope_(Trace::id)
+#else
+#define TRACE_SCOPE(id)
+#endif
+
+// Objects that live until the next reset but are created at runtime (once the
+// device is known) are constructed in this static buffer with placement new. They
+// are never destroyed, so allocation is a bump of the offset. Keeping them off the
+// heap leaves the heap to short-lived Strings, which can't fragment it for good.
+#include <new>
+#include <utility>
+#include <malloc.h>
+class StaticArena {
+  private:
+    static const size_t SIZE = 64;
+    alignas(max_align_t) static uint8_t buf[SIZE];
+    static size_t   used;
+    static uint32_t heapFallbacks;
+  public:
+    // Falls back to the heap (counted in the "heap" setting) once the arena is
+    // full. A T that can never fit is a compile error, raise SIZE for it.
+    template <class T, class... Args>
+    static T* create(Args&&... args) {
+      static_assert(sizeof(T) <= SIZE, "StaticArena::SIZE is too small for T");
+      size_t start = (used + alignof(T) - 1) & ~(alignof(T) - 1);
+      if (start + sizeof(T) > SIZE) {
+        heapFallbacks++;
+        return new T(std::forward<Args>(args)...);
+      }
+      used = start + sizeof(T);
+      return new (buf + start) T(std::forward<Args>(args)...);
+    }
+    static void addJson(String& json) {
+      JSonizer::addSetting(json, "arenaUsed", String(used));
+      JSonizer::addSetting(json, "arenaSize", String(SIZE));
+      JSonizer::addSetting(json, "arenaHeapFallbacks", String(heapFallbacks));
+    }
+};
+
+alignas(max_align_t) uint8_t StaticArena::buf[StaticArena::SIZE];
+size_t   StaticArena::used = 0;
+uint32_t StaticArena::heapFallbacks = 0;
+
+// Heap report for the "heap" setting.
+// - freeMemory is System.freeMemory(), the free heap as Device OS counts it.
+//   This is the number to go by.
+// - The other numbers come from mallinfo() of the newlib linked into the
+//   application. On the Photon, malloc() may be served by the system part,
+//   and then this mallinfo() does not see those allocations. That is not
+//   confirmed, so the numbers are only published when mallinfo() reports a
+//   heap at all ("mallinfo": "none" otherwise).
+// The heap only grows (sbrk), so its size is the high-water mark. Free bytes
+// below the top chunk are holes between allocations: their share of the free
+// bytes in the heap is the fragmentation.
+class HeapStats {
+  public:
+    static void publishJson() {
+      struct mallinfo mi = mallinfo();
+      String json("{");
+      JSonizer::addFirstSetting(json, "freeMemory", String(System.freeMemory()));
+      if (mi.arena == 0) {
+        JSonizer::addSetting(json, "mallinfo", "none");
+      } else {
+        uint32_t holes = mi.fordblks - mi.keepcost;
+        JSonizer::addSetting(json, "heapHighWater", String((uint32_t)mi.arena));
+        JSonizer::addSetting(json, "inUse", String((uint32_t)mi.uordblks));
+        JSonizer::addSetting(json, "freeInHeap", String((uint32_t)mi.fordblks));
+        JSonizer::addSetting(json, "freeChunks", String((uint32_t)mi.ordblks));
+        JSonizer::addSetting(json, "fragmentationPct", String(mi.fordblks ? holes * 100 / mi.fordblks : 0));
+      }
+      StaticArena::addJson(json);
+      json.concat("}");
+      Particle.publish("Heap json", json);
+    }
+};
+
 class TimeSupport {
   private:
-    unsigned long ONE_DAY_IN_MILLISECONDS;
-    unsigned long lastSyncMillis;
+    uint64_t lastSyncMillis;
     int timeZoneOffset;
+
+    // Formatted time cache: the date and zone parts of an ISO8601 string only
+    // change once a day, so only the hh:mm:ss digits are rewritten in place.
+    static const int HOUR_POS = 11;   // "YYYY-MM-DDThh:mm:ss..."
+    char          formatBuf[32];
+    time_t        formatBase = 0;     // epoch of the last full Time.format()
+    unsigned long formatBaseSecOfDay = 0;
+    void formatFull(time_t t);
+    static void put2Digits(char* p, unsigned long v) {
+      p[0] = '0' + v / 10;
+      p[1] = '0' + v % 10;
+    }
+
+    // US DST boundaries of one year in UTC epoch seconds, so that isDST()
+    // is a comparison and the switch happens at 2:00 AM local time.
+    int           dstYear = 0;
+    time_t        dstYearStart = 0;   // Jan 1 00:00 UTC of dstYear
+    time_t        dstYearEnd = 0;     // Jan 1 00:00 UTC of the next year
+    time_t        dstStart = 0;       // second Sunday in March
+    time_t        dstEnd = 0;         // first Sunday in November
+    time_t        nextDSTChange = 0;
+    static long daysFromCivil(int y, unsigned int m, unsigned int d);
+    static long nthSunday(int y, unsigned int m, int n);
+    void computeDSTTable(time_t t);
+
     String getSettings();
     bool isDST();
+    bool isDST(time_t t);
     void setDST();
     void doHandleTime();
   public:
     TimeSupport(int timeZoneOffset);
     String timeStr(time_t t);
+    const char* format(time_t t);
     String now();
     void handleTime();
     int setTimeZoneOffset(String command);
     void publishJson();
-    String getUpTime();
-    String getMinSecString(unsigned long ms);
+    static const size_t MIN_SEC_SIZE = 8;     // "mm:ss"
+    const char* getUpTime(char* buf, size_t size);
+    static const char* formatMinSec(char* buf, size_t size, uint64_t ms);
 };
 
 String TimeSupport::getSettings() {
     time_t n = Time.now();
-    time_t restarted = n - (millis() / 1000);
+    time_t restarted = n - (Clock::millis64() / 1000);
     time_t lastSyncTime = restarted + (lastSyncMillis / 1000);
 
     String json("{");
     JSonizer::addFirstSetting(json, "restarted", timeStr(restarted));
-    JSonizer::addSetting(json, "lastSyncMillis", String(lastSyncMillis));
+    JSonizer::addSetting(json, "lastSyncMillis", JSonizer::toString(lastSyncMillis));
     JSonizer::addSetting(json, "lastSyncTime", timeStr(lastSyncTime));
     JSonizer::addSetting(json, "timeZoneOffset", String(timeZoneOffset));
     JSonizer::addSetting(json, "isDST", JSonizer::toString(isDST()));
+    JSonizer::addSetting(json, "nextDSTChange", timeStr(nextDSTChange));
     JSonizer::addSetting(json, "internalTime", now());
     json.concat("}");
     return json;
@@ -85,32 +419,88 @@ TimeSupport::TimeSupport(int timeZoneOffset) {
 }
 
 void TimeSupport::setDST() {
-    if (isDST()) {
+    time_t t = Time.now();
+    if (isDST(t)) {
       Time.beginDST();
+      nextDSTChange = dstEnd;
     } else {
       Time.endDST();
+      nextDSTChange = (t < dstStart) ? dstStart : dstYearEnd;
     }
+    formatBase = 0;
+}
+
+// Days since 1970-01-01 of a date in the proleptic Gregorian calendar.
+long TimeSupport::daysFromCivil(int y, unsigned int m, unsigned int d) {
+    y -= m <= 2;
+    const long era = y / 400;
+    const unsigned int yoe = y - era * 400;
+    const unsigned int doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+long TimeSupport::nthSunday(int y, unsigned int m, int n) {
+    long first = daysFromCivil(y, m, 1);
+    int weekday = (first + 4) % 7;    // 1970-01-01 was a Thursday, 0 is Sunday
+    return first + (7 - weekday) % 7 + 7 * (n - 1);
+}
+
+void TimeSupport::computeDSTTable(time_t t) {
+    const long ONE_DAY_IN_SECONDS = 24 * 60 * 60;
+    const long ONE_HOUR_IN_SECONDS = 60 * 60;
+    dstYear = 1970 + t / (365L * ONE_DAY_IN_SECONDS);
+    while (daysFromCivil(dstYear, 1, 1) * ONE_DAY_IN_SECONDS > t) {
+      dstYear--;
+    }
+    while (daysFromCivil(dstYear + 1, 1, 1) * ONE_DAY_IN_SECONDS <= t) {
+      dstYear++;
+    }
+    dstYearStart = daysFromCivil(dstYear, 1, 1) * ONE_DAY_IN_SECONDS;
+    dstYearEnd = daysFromCivil(dstYear + 1, 1, 1) * ONE_DAY_IN_SECONDS;
+    // 2:00 AM standard time, and 2:00 AM daylight time (= 1:00 AM standard time)
+    dstStart = nthSunday(dstYear, 3, 2) * ONE_DAY_IN_SECONDS
+                  + (2 - timeZoneOffset) * ONE_HOUR_IN_SECONDS;
+    dstEnd = nthSunday(dstYear, 11, 1) * ONE_DAY_IN_SECONDS
+                  + (1 - timeZoneOffset) * ONE_HOUR_IN_SECONDS;
 }
 
 bool TimeSupport::isDST() {
-  int dayOfMonth = Time.day();
-  int month = Time.month();
-  int dayOfWeek = Time.weekday();
-	if (month < 3 || month > 11) {
-		return false;
-	}
-	if (month > 3 && month < 11) {
-		return true;
-	}
-	int previousSunday = dayOfMonth - (dayOfWeek - 1);
-	if (month == 3) {
-		return previousSunday >= 8;
-	}
-	return previousSunday <= 0;
+    return isDST(Time.now());
+}
+
+bool TimeSupport::isDST(time_t t) {
+    if (dstYear == 0 || t < dstYearStart || t >= dstYearEnd) {
+      computeDSTTable(t);
+    }
+    return t >= dstStart && t < dstEnd;
+}
+
+void TimeSupport::formatFull(time_t t) {
+    String s = Time.format(t, TIME_FORMAT_ISO8601_FULL);
+    strncpy(formatBuf, s.c_str(), sizeof(formatBuf) - 1);
+    formatBuf[sizeof(formatBuf) - 1] = '\0';
+    formatBase = t;
+    formatBaseSecOfDay = Time.hour(t) * 3600UL + Time.minute(t) * 60UL + Time.second(t);
+}
+
+// Returns a pointer to an internal buffer, valid until the next call.
+const char* TimeSupport::format(time_t t) {
+    const unsigned long ONE_DAY_IN_SECONDS = 24 * 60 * 60;
+    if (formatBase == 0 || t < formatBase ||
+          formatBaseSecOfDay + (unsigned long)(t - formatBase) >= ONE_DAY_IN_SECONDS) {
+      formatFull(t);
+      return formatBuf;
+    }
+    unsigned long secOfDay = formatBaseSecOfDay + (unsigned long)(t - formatBase);
+    put2Digits(formatBuf + HOUR_POS, secOfDay / 3600);
+    put2Digits(formatBuf + HOUR_POS + 3, (secOfDay / 60) % 60);
+    put2Digits(formatBuf + HOUR_POS + 6, secOfDay % 60);
+    return formatBuf;
 }
 
 String TimeSupport::timeStr(time_t t) {
-    return Time.format(t, TIME_FORMAT_ISO8601_FULL);
+    return String(format(t));
 }
 
 String TimeSupport::now() {
@@ -118,15 +508,21 @@ String TimeSupport::now() {
 }
 
 void TimeSupport::doHandleTime() {
+  TRACE_SCOPE(TIME_SYNC);
   Particle.syncTime();
+  this->dstYear = 0;      // time or zone may have changed
   this->setDST();
   Time.zone(this->timeZoneOffset);
-  this->lastSyncMillis = millis();
+  this->formatBase = 0;
+  this->lastSyncMillis = Clock::millis64();
 }
 
 void TimeSupport::handleTime() {
-    long unsigned int ONE_DAY_IN_MILLISECONDS = 24 * 60 * 60 * 1000;
-    if (millis() - lastSyncMillis > ONE_DAY_IN_MILLISECONDS) {    // If it's been a day since last sync...
+    if (Time.now() >= nextDSTChange) {
+      this->setDST();
+    }
+    const uint64_t ONE_DAY_IN_MILLISECONDS = 24 * 60 * 60 * 1000;
+    if (Clock::millis64() - lastSyncMillis > ONE_DAY_IN_MILLISECONDS) {    // If it's been a day since last sync...
                                                             // Request time synchronization from the Particle Cloud
       this->doHandleTime();
     }
@@ -136,52 +532,79 @@ void TimeSupport::publishJson() {
     Particle.publish("TimeSupport", getSettings());
 }
 
-String TimeSupport::getMinSecString(unsigned long ms) {
-  unsigned long seconds = (ms / 1000) % 60;
-  unsigned long minutes = (ms / 1000 / 60) % 60;
-  char s[32];
-  sprintf(s, "%02u:%02u", minutes, seconds);
-  String elapsed(s);
-  return elapsed;
+const char* TimeSupport::formatMinSec(char* buf, size_t size, uint64_t ms) {
+  unsigned int seconds = (ms / 1000) % 60;
+  unsigned int minutes = (ms / 1000 / 60) % 60;
+  snprintf(buf, size, "%02u:%02u", minutes, seconds);
+  return buf;
 }
 
-String TimeSupport::getUpTime() {
-  return getMinSecString(millis());
+const char* TimeSupport::getUpTime(char* buf, size_t size) {
+  return formatMinSec(buf, size, Clock::millis64());
 }
 
 TimeSupport    timeSupport(-8);
 
 #define DELAY_BEFORE_RESET 2000
 const unsigned int resetDelayMillis = DELAY_BEFORE_RESET;
-unsigned long resetSync = millis();
+uint64_t resetSync = 0;
 bool resetFlag = false;
 
-const static String PHOTON_01 = "1c002c001147343438323536";
-const static String PHOTON_02 = "300040001347343438323536";
-const static String PHOTON_05 = "19002a001347363336383438";
-const static String PHOTON_07 = "32002e000e47363433353735";
-const static String PHOTON_08 = "500041000b51353432383931";
-const static String PHOTON_09 = "1f0027001347363336383437";
-const static String PHOTON_10 = "410027001247363335343834";
-const static String PHOTON_15 = "270037000a47373336323230";
-const static String PHOTON2_16= "0a10aced202194944a045288";
-const static String PHOTON2_17= "0a10aced202194944a045200";
+constexpr const char* PHOTON_01 = "1c002c001147343438323536";
+constexpr const char* PHOTON_02 = "300040001347343438323536";
+constexpr const char* PHOTON_05 = "19002a001347363336383438";
+constexpr const char* PHOTON_07 = "32002e000e47363433353735";
+constexpr const char* PHOTON_08 = "500041000b51353432383931";
+constexpr const char* PHOTON_09 = "1f0027001347363336383437";
+constexpr const char* PHOTON_10 = "410027001247363335343834";
+constexpr const char* PHOTON_15 = "270037000a47373336323230";
+constexpr const char* PHOTON2_16= "0a10aced202194944a045288";
+constexpr const char* PHOTON2_17= "0a10aced202194944a045200";
 
 const uint16_t  BASE_LINE = 425;
 const uint16_t  MAX_VIBRATION_VALUE = 150 + BASE_LINE; // Keep max low enough to show 'usual' vibration in graph.
+const uint16_t  NO_VIBRATION_SENSOR_ATTACHED = 575;    // zero correction of the test units
+
+// Per device parameters, for the Utils getters and the sensor pipeline
+// (createSensorPipeline()). fixedProfile: the pipeline is compiled for the
+// device (FixedProfile), else it reads the parameters at runtime.
+struct DeviceParams {
+  const char* id;
+  const char* name;
+  const char* location;
+  uint16_t    baseline;
+  uint16_t    zeroCorrection;
+  uint16_t    maxValue;
+  bool        fixedProfile;
+};
+
+constexpr DeviceParams DEVICES[] = {
+  { PHOTON_01,  "PHOTON_01",  "Dryer",        75,  555, MAX_VIBRATION_VALUE + 100, true },
+  { PHOTON_05,  "PHOTON_05",  "Test Unit 05", 100, NO_VIBRATION_SENSOR_ATTACHED, MAX_VIBRATION_VALUE, false },
+  { PHOTON_07,  "PHOTON_07",  "Test Unit 07", 100, 415, MAX_VIBRATION_VALUE, true },
+  { PHOTON_08,  "PHOTON_08",  "Washer",       75,  440, MAX_VIBRATION_VALUE, true },
+  { PHOTON_09,  "PHOTON_09",  "Test Unit 09", 75,  NO_VIBRATION_SENSOR_ATTACHED, MAX_VIBRATION_VALUE, false },
+  { PHOTON_10,  "PHOTON_10",  "Test Unit 10", 75,  460, MAX_VIBRATION_VALUE, true },
+  { PHOTON_15,  "PHOTON_15",  "Test Unit 15", 75,  490, MAX_VIBRATION_VALUE, true },
+  { PHOTON2_16, "PHOTON2_16", "Test Unit 16", 75,  NO_VIBRATION_SENSOR_ATTACHED, MAX_VIBRATION_VALUE, false },
+  { PHOTON2_17, "PHOTON2_17", "Test Unit 17", 75,  NO_VIBRATION_SENSOR_ATTACHED, MAX_VIBRATION_VALUE, false },
+};
+constexpr int NUM_DEVICES = sizeof(DEVICES) / sizeof(DEVICES[0]);
+constexpr DeviceParams UNKNOWN_DEVICE =
+  { nullptr, nullptr, nullptr, 75, NO_VIBRATION_SENSOR_ATTACHED, MAX_VIBRATION_VALUE, false };
 
 class Utils {
   public:
-    static unsigned long startPublishDataMillis;
+    static uint64_t      startPublishDataMillis;
     static bool          alwaysPublishData;
     const static unsigned long ALWAYS_PUBLISH_DATA_MILLIS = 1000 * 60 * 60 * 3; // 3 hours
 
     static void setAlwaysPublishData() {
       alwaysPublishData = true;
-      startPublishDataMillis = millis();
+      startPublishDataMillis = Clock::millis64();
     }
     static bool publishDataDone() {
-      if (millis() - startPublishDataMillis > ALWAYS_PUBLISH_DATA_MILLIS) {
+      if (Clock::millis64() - startPublishDataMillis > ALWAYS_PUBLISH_DATA_MILLIS) {
         alwaysPublishData = false;
         startPublishDataMillis = 0;
         return true;
@@ -196,36 +619,41 @@ class Utils {
       }
       return -1;
     }
-    static void publishAndWait(String event, String data, int theDelay) {
+    static void publishAndWait(const char* event, const char* data, int theDelay) {
+      TRACE_SCOPE(PUBLISH);
       Particle.publish(event, data);
       delay(theDelay);
     }
-    static void publishForDebug(String event, String data) {
-      publishAndWait(event, data, 3000);
+    static void publishAndWait(String event, String data, int theDelay) {
+      publishAndWait(event.c_str(), data.c_str(), theDelay);
+    }
+    static void publish(const char* event, const char* data) {
+      publishAndWait(event, data, 1000);
     }
     static void publish(String event, String data) {
       publishAndWait(event, data, 1000);
     }
-    static String elapsedTime(unsigned long ms) {
-      unsigned long seconds = (ms / 1000) % 60;
-      unsigned long minutes = (ms / 1000 / 60) % 60;
-      unsigned long hours = (ms / 1000 / 60 / 60);
-      String elapsed;
+    static const size_t ELAPSED_TIME_SIZE = 16;   // "hours > 24"
+    // Formats into buf, so the display paths don't allocate.
+    static const char* formatElapsedTime(char* buf, size_t size, uint64_t ms) {
+      unsigned int  seconds = (ms / 1000) % 60;
+      unsigned int  minutes = (ms / 1000 / 60) % 60;
+      uint64_t      hours = (ms / 1000 / 60 / 60);
       if (hours > 24) {
-        elapsed.concat("hours > 24");
+        snprintf(buf, size, "hours > 24");
+      } else if (hours > 9) {
+        snprintf(buf, size, "!:%02u:%02u", minutes, seconds);
       } else {
-        char s[32];
-        if (hours > 9) {
-          sprintf(s, "!:%02u:%02u", minutes, seconds);
-        } else {
-          sprintf(s, "%01u:%02u:%02u", hours, minutes, seconds);
-        }
-        elapsed.concat(s);
+        snprintf(buf, size, "%01u:%02u:%02u", (unsigned int)hours, minutes, seconds);
       }
-      return elapsed;
+      return buf;
+    }
+    static String elapsedTime(uint64_t ms) {
+      char s[ELAPSED_TIME_SIZE];
+      return String(formatElapsedTime(s, sizeof(s), ms));
     }
     static String elapsedUpTime() {
-      return elapsedTime(millis());
+      return elapsedTime(Clock::millis64());
     }
     static void publishJson() {
       String json("{");
@@ -236,72 +664,52 @@ class Utils {
       JSonizer::addSetting(json, "getDeviceLocation", getDeviceLocation());
       JSonizer::addSetting(json, "getDeviceBaseline", String(getDeviceBaseline()));
       JSonizer::addSetting(json, "getDeviceZeroCorrection", String(getDeviceZeroCorrection()));
-      JSonizer::addSetting(json, "startPublishDataMillis", String(startPublishDataMillis));
+      JSonizer::addSetting(json, "startPublishDataMillis", JSonizer::toString(startPublishDataMillis));
       JSonizer::addSetting(json, "alwaysPublishData", JSonizer::toString(alwaysPublishData));
       JSonizer::addSetting(json, "ALWAYS_PUBLISH_DATA_MILLIS", String(ALWAYS_PUBLISH_DATA_MILLIS));
       json.concat("}");
       Particle.publish("Utils json", json);
     }
-    static String getDeviceID() {
+    // Index into DEVICES, -1 for an unknown device.
+    static int getDeviceIndex() {
       String deviceID = System.deviceID();
-      if (deviceID.equals(PHOTON_01)) { return "PHOTON_01"; }
-      if (deviceID.equals(PHOTON_05)) { return "PHOTON_05"; }
-      if (deviceID.equals(PHOTON_07)) { return "PHOTON_07"; }
-      if (deviceID.equals(PHOTON_08)) { return "PHOTON_08"; }
-      if (deviceID.equals(PHOTON_09)) { return "PHOTON_09"; }
-      if (deviceID.equals(PHOTON_10)) { return "PHOTON_10"; }
-      if (deviceID.equals(PHOTON_15)) { return "PHOTON_15"; }
-      if (deviceID.equals(PHOTON2_16)){ return "PHOTON2_16"; }
-      if (deviceID.equals(PHOTON2_17)){ return "PHOTON2_17"; }
-      return "Unknown deviceID: " + deviceID;
+      for (int i = 0; i < NUM_DEVICES; i++) {
+        if (deviceID.equals(DEVICES[i].id)) { return i; }
+      }
+      return -1;
+    }
+    static const DeviceParams& getDevice() {
+      int i = getDeviceIndex();
+      return i < 0 ? UNKNOWN_DEVICE : DEVICES[i];
+    }
+    static String getDeviceID() {
+      int i = getDeviceIndex();
+      if (i >= 0) { return DEVICES[i].name; }
+      return "Unknown deviceID: " + System.deviceID();
     }
     static String getDeviceLocation() {
-      String deviceID = System.deviceID();
-      if (deviceID.equals(PHOTON_01)) { return "Dryer";  }
-      if (deviceID.equals(PHOTON_05)) { return "Test Unit 05"; }
-      if (deviceID.equals(PHOTON_07)) { return "Test Unit 07"; }
-      if (deviceID.equals(PHOTON_08)) { return "Washer"; }
-      if (deviceID.equals(PHOTON_09)) { return "Test Unit 09"; }
-      if (deviceID.equals(PHOTON_10)) { return "Test Unit 10"; }
-      if (deviceID.equals(PHOTON_15)) { return "Test Unit 15"; }
-      if (deviceID.equals(PHOTON2_16)){ return "Test Unit 16"; }
-      if (deviceID.equals(PHOTON2_17)){ return "Test Unit 17"; }
+      int i = getDeviceIndex();
+      if (i >= 0) { return DEVICES[i].location; }
       return getDeviceID();
     }
     static uint16_t getDeviceBaseline() {
-      String deviceID = System.deviceID();
-      if (deviceID.equals(PHOTON_01)) { return 75; }
-      if (deviceID.equals(PHOTON_05)) { return 100; }
-      if (deviceID.equals(PHOTON_07)) { return 100; }
-      if (deviceID.equals(PHOTON_08)) { return 75; }
-      if (deviceID.equals(PHOTON_09)) { return 75; }
-      if (deviceID.equals(PHOTON_10)) { return 75; }
-      return 75;
+      return getDevice().baseline;
     }
     static uint16_t getDeviceZeroCorrection() {
-      String deviceID = System.deviceID();
-      if (deviceID.equals(PHOTON_01)) { return 555; }
-      if (deviceID.equals(PHOTON_07)) { return 415; }
-      if (deviceID.equals(PHOTON_08)) { return 440; }
-      if (deviceID.equals(PHOTON_10)) { return 460; }
-      if (deviceID.equals(PHOTON_15)) { return 490; }
-      const uint16_t NO_VIBRATION_SENSOR_ATTACHED = 575;
-      return NO_VIBRATION_SENSOR_ATTACHED;
+      return getDevice().zeroCorrection;
     }
     static uint16_t getMaxVibrationValue() {
-      String deviceLocation = getDeviceLocation();
-      if (deviceLocation.equals("Dryer")) { return MAX_VIBRATION_VALUE + 100; }
-      return MAX_VIBRATION_VALUE;
+      return getDevice().maxValue;
     }
     static void checkForRemoteReset() {
-      if ((resetFlag) && (millis() - resetSync >=  resetDelayMillis)) {
+      if ((resetFlag) && (Clock::millis64() - resetSync >=  resetDelayMillis)) {
         Particle.publish("Debug", "System.reset() Initiated", 300, PRIVATE);
         System.reset();
       }
     }
 };
 
-unsigned long Utils::startPublishDataMillis = 0;
+uint64_t      Utils::startPublishDataMillis = 0;
 bool          Utils::alwaysPublishData = true;
 
 int setAlwaysPublishData(String command) {
@@ -311,314 +719,1488 @@ int setAlwaysPublishData(String command) {
 
 int remoteResetFunction(String command) {
   resetFlag = true;
-  resetSync = millis();
+  resetSync = Clock::millis64();
   return 0;
 }
 
+// The edges of the button are captured by an interrupt, so a press during a sample
+// burst is not missed. The ISR only appends the level and its micros() to a single
+// producer, single consumer ring. checkState() drains it in the loop and debounces
+// with the edge timestamps: a level counts once it was stable for BOUNCE_DELAY_US,
+// independent of how long the loop takes. A press is tagged with the edge where the
+// level first left the stable state, not with its last bounce.
+#include <atomic>
 class Button {
   private:
-    int                 pin;
-    int                 buttonState;            // the current reading from the input pin
+    // An edge with the sample block and publish interval it happened in,
+    // see blockStarted().
+    struct Edge {
+      uint32_t us;
+      uint32_t blockTag;    // block number << 1 | 1 during the burst
+      uint32_t interval;
+      uint8_t  level;
+    };
+    static const uint32_t QUEUE_SIZE = 32;              // must be a power of 2
+    static const uint32_t BOUNCE_DELAY_US = 50 * 1000;  // increase if presses flicker
+
+    int                   pin;
+    Edge                  edges[QUEUE_SIZE];
+    std::atomic<uint32_t> head { 0 };           // written by onEdge() only
+    std::atomic<uint32_t> tail { 0 };           // written by checkState() only
+    std::atomic<uint32_t> overflows { 0 };      // edges dropped by onEdge(), queue full
+    uint32_t              seenOverflows = 0;
+    std::atomic<uint32_t> blockTag { 0 };       // written by the sampling loop, read by onEdge()
+    std::atomic<uint32_t> interval { 0 };
+
+    int                   buttonState = LOW;    // the debounced level
+    Edge                  pending = {};         // the last edge, its level is pending
+    Edge                  leaving = {};         // the first edge away from buttonState
+    bool                  isLeaving = false;    // since the level was last stable
+    uint32_t              presses = 0;
+    Edge                  lastPressEdge = {};   // the first edge of the last press
+
+    void onEdge() {
+      uint32_t h = head.load(std::memory_order_relaxed);
+      if (h - tail.load(std::memory_order_acquire) == QUEUE_SIZE) {
+        overflows.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      edges[h & (QUEUE_SIZE - 1)] = edgeNow();
+      head.store(h + 1, std::memory_order_release);
+    }
 
-    unsigned long       lastDebounceTime = 0;  // the last time the output pin was toggled
-    unsigned const long BOUNCE_DELAY = 50;    // the debounce time; increase if the output flickers
-    int                 lastButtonState = LOW;  // the previous reading from the input pin
+    Edge edgeNow() {
+      return Edge { (uint32_t)micros(), blockTag.load(std::memory_order_relaxed),
+                    interval.load(std::memory_order_relaxed), (uint8_t)digitalRead(pin) };
+    }
+
+    // Accepts the pending level if it was stable until `us`. A press gets the
+    // first edge of its bounces.
+    void settle(uint32_t us) {
+      if (us - pending.us < BOUNCE_DELAY_US) {
+        return;
+      }
+      if (pending.level != buttonState) {
+        buttonState = pending.level;
+        if (buttonState == HIGH) {
+          presses++;
+          lastPressEdge = leaving;
+        }
+      }
+      isLeaving = false;
+    }
+
+    void setPending(const Edge& e) {
+      settle(e.us);
+      if (!isLeaving && e.level != buttonState) {
+        leaving = e;
+        isLeaving = true;
+      }
+      pending = e;
+    }
 
   public:
 
     Button(int p) : pin(p) {}
     void begin() {
       pinMode(pin, INPUT);
+      pending = edgeNow();
+      buttonState = pending.level;
+      attachInterrupt(pin, &Button::onEdge, this, CHANGE);
     }
-    void checkState() {
-      int reading = digitalRead(pin);
-      if (reading != lastButtonState) {
-        lastDebounceTime = millis();
+
+    // Returns the number of presses that became stable since the last call.
+    uint32_t checkState() {
+      uint32_t before = presses;
+      uint32_t t = tail.load(std::memory_order_relaxed);
+      uint32_t h = head.load(std::memory_order_acquire);
+      for (; t != h; t++) {
+        const Edge& e = edges[t & (QUEUE_SIZE - 1)];
+        setPending(e);
       }
-      if ((millis() - lastDebounceTime) > BOUNCE_DELAY) {
-        if (reading != buttonState) {
-          buttonState = reading;
-        }
+      tail.store(t, std::memory_order_release);
+      uint32_t now = micros();
+      uint32_t o = overflows.load(std::memory_order_relaxed);
+      if (o != seenOverflows) {
+        seenOverflows = o;
+        setPending(edgeNow());  // edges are lost, start again from the pin
       }
-      lastButtonState = reading;
+      settle(now);
+      return presses - before;
     }
     bool isPressed() {
       return buttonState == HIGH;
     }
+    // Called by the sampling loop, so that onEdge() tags each edge with the
+    // current block and interval, also while the burst blocks the loop.
+    void blockStarted(uint32_t block) {
+      blockTag.store(block << 1 | 1, std::memory_order_relaxed);
+    }
+    void blockEnded(uint32_t block) {
+      blockTag.store(block << 1, std::memory_order_relaxed);
+    }
+    void intervalStarted(uint32_t n) {
+      interval.store(n, std::memory_order_relaxed);
+    }
+
+    // Of the first edge of the last press: micros(), the last block that
+    // started before it, whether it was during that block's burst, and the
+    // publish interval.
+    uint32_t lastPress() {
+      return lastPressEdge.us;
+    }
+    uint32_t lastPressBlock() {
+      return lastPressEdge.blockTag >> 1;
+    }
+    bool lastPressInBlock() {
+      return lastPressEdge.blockTag & 1;
+    }
+    uint32_t lastPressInterval() {
+      return lastPressEdge.interval;
+    }
+    uint32_t getPresses() {
+      return presses;
+    }
+    uint32_t getOverflows() {
+      return overflows.load(std::memory_order_relaxed);
+    }
 };
 Button button(D2);
 
+// Define exactly one display configuration. OLED_MICRO and OLED_SSD1327 link only
+// their driver: the calls are resolved (and inlined) at compile time, and the other
+// driver with its fonts and the global u8g2 object is not in the binary.
+// OLED_SWITCHABLE (for debugging) links both drivers behind virtual calls, starts
+// with the MicroOLED and adds the "switchOled" function to change to the SSD1327.
+// The host tests define one of them on the command line.
+#if !defined(OLED_MICRO) && !defined(OLED_SSD1327) && !defined(OLED_SWITCHABLE)
+#define OLED_MICRO
+// #define OLED_SSD1327
+// #define OLED_SWITCHABLE
+#endif
+
+#if defined(OLED_MICRO) + defined(OLED_SSD1327) + defined(OLED_SWITCHABLE) != 1
+#error "define exactly one of OLED_MICRO, OLED_SSD1327, OLED_SWITCHABLE"
+#endif
+
+// A driver has the frame buffer primitives used by Display: draw...() only writes
+// the frame buffer, flush() sends it to the panel, see RenderScheduler.
+#if defined(OLED_MICRO) || defined(OLED_SWITCHABLE)
 #include <SparkFunMicroOLED.h>
-class OLEDWrapper {
+class MicroOLEDDriver {
   private:
-      void display_no_clear(String title, int font, uint8_t x, uint8_t y) {
-        oled->setFontType(font);
-        oled->setCursor(x, y);
-        oled->print(title);
-        oled->display();
-    }
+    MicroOLED oled;
   public:
-    MicroOLED* oled = new MicroOLED();
+    const char* name() {
+      return "MicroOLED";
+    }
 
-    int       lastDisplay = 0;
-    const int DISPLAY_RATE_IN_MS = 1000;
-    int       baseline = 0;
-    const int MAX_BASELINE = 16;
+    // Leaves the splash screen on the panel, RenderScheduler::show(nullptr, ...) keeps it.
+    void startup() {
+        oled.begin();    // Initialize the OLED
+        oled.clear(ALL); // Clear the display's internal memory
+        oled.display();  // Display what's in the buffer (splashscreen)
+        oled.clear(PAGE); // Clear the buffer.
+    }
 
-    virtual void startup() {
-        oled->begin();    // Initialize the OLED
-        oled->clear(ALL); // Clear the display's internal memory
-        oled->display();  // Display what's in the buffer (splashscreen)
-        delay(1000);     // Delay 1000 ms
-        oled->clear(PAGE); // Clear the buffer.
+    void clearBuffer() {
+        oled.clear(PAGE);
     }
 
-    virtual void display(String title, int font, uint8_t x, uint8_t y) {
-        oled->clear(PAGE);
-        display_no_clear(title, font, x, y);
+    void draw(const char* title, int font, uint8_t x, uint8_t y) {
+        oled.setFontType(font);
+        oled.setCursor(x, y);
+        oled.print(title);
     }
 
-    virtual void display(String title, int font) {
-        display(title, font, 0, 0);
+    void flush() {
+        TRACE_SCOPE(DISPLAY_FLUSH);
+        oled.display();
     }
 
-    virtual void displayNumber(String s) {
-        // To reduce OLED burn-in, shift the digits (if possible) on the odd minutes.
-        int x = 0;
-        if (Time.minute() % 2) {
-            const int MAX_DIGITS = 5;
-            if (s.length() < MAX_DIGITS) {
-                const int FONT_WIDTH = 12;
-                x += FONT_WIDTH * (MAX_DIGITS - s.length());
-            }
-        }
-        display(s, 3, x, 0);
+    uint8_t width() {
+        return oled.getLCDWidth();
     }
 
-    virtual void displayValueAndTime(int value, String timeStr) {
-      int thisMS = millis();
-      if (thisMS - lastDisplay > DISPLAY_RATE_IN_MS) {
-        clear();
-        display(String(value), 1, 0, baseline);
-        display_no_clear(timeStr, 1, 0, baseline + 16);
-        baseline++;
-        if (baseline > MAX_BASELINE) {
-          baseline = 0;
+    uint8_t height() {
+        return oled.getLCDHeight();
+    }
+
+    void clearArea(uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+        oled.rectFill(x, y, w, h, BLACK, NORM);
+    }
+
+    // A bar of fill pixels at the bottom of the column x, y ... y + h - 1.
+    void drawColumn(uint8_t x, uint8_t y, uint8_t h, uint8_t fill) {
+        oled.lineV(x, y, h, BLACK, NORM);
+        if (fill > 0) {
+            oled.lineV(x, y + h - fill, fill, WHITE, NORM);
         }
-        lastDisplay = millis();
-      }
     }
 
-    virtual void publishJson() {
-        String json("{");
-        JSonizer::addFirstSetting(json, "getLCDWidth()", String(oled->getLCDWidth()));
-        JSonizer::addSetting(json, "getLCDHeight()", String(oled->getLCDHeight()));
-        JSonizer::addSetting(json, "lastDisplay", String(lastDisplay));
-        JSonizer::addSetting(json, "DISPLAY_RATE_IN_MS", String(DISPLAY_RATE_IN_MS));
-        JSonizer::addSetting(json, "baseline", String(baseline));
-        JSonizer::addSetting(json, "MAX_BASELINE", String(MAX_BASELINE));
-        json.concat("}");
-        Particle.publish("OLED", json);
+    // The MicroOLED library always writes the whole (384 byte) buffer.
+    void flushArea(uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+        flush();
     }
 
-    virtual void clear() {
-      oled->clear(ALL);
+    void clear() {
+      oled.clear(ALL);
     }
 };
+#endif
+
+#if defined(OLED_SSD1327) || defined(OLED_SWITCHABLE)
+// Uncomment to drive the SSD1327 with its native 16 gray levels: antialiased digits and no
+// conversion on send, but the frame buffer needs 8 KB instead of 2 KB of RAM.
+// #define OLED_GRAY4
 
 #include <U8g2lib.h>
+#ifdef OLED_GRAY4
+U8G2_SSD1327_EA_W128128_G4_HW_I2C u8g2(U8G2_R0, U8X8_PIN_NONE);
+#else
 U8G2_SSD1327_EA_W128128_F_HW_I2C u8g2(U8G2_R0, U8X8_PIN_NONE);
+#endif
 // Won't compile inside class, so use global variable instead of member variable.
 
-class OLEDWrapperU8g2 : public OLEDWrapper {
+class U8g2Driver {
   private:
-    void display_(String s, int x, int y) {
-      // u8g2.drawUTF8(x, y, s.c_str());
-      Utils::publish("Debug", "Displaying: " + s);
-    }
     void u8g2_prepare(void) {
       u8g2.setFont(u8g2_font_fur49_tn);
       u8g2.setFontRefHeightExtendedText();
-      u8g2.setDrawColor(1);
+      u8g2.setFontPosTop();       // y is the top of the text, like the MicroOLED cursor
+      u8g2.setDrawColor(u8g2.isGray4() ? 15 : 1);
       u8g2.setFontDirection(0);
     }
-    void startDisplay(const uint8_t *font) {
-      u8g2_prepare();
-      u8g2.clearBuffer();
-      u8g2.setFont(font);
-    }
-    void endDisplay() {
-      u8g2.sendBuffer();
-    }
   public:
-    void startup() override {
+    const char* name() {
+      return "U8g2 SSD1327";
+    }
+    void startup() {
       pinMode(10, OUTPUT);
       pinMode(9, OUTPUT);
       digitalWrite(10, 0);
       digitalWrite(9, 0);
-      Utils::publishForDebug("Debug", "before u8g2.begin();");
       if (!u8g2.begin()) {
         Utils::publish("FAIL", "u8g2.begin");
       }
-      Utils::publishForDebug("Debug", "before u8g2.setBusClock(400000);");
       u8g2.setBusClock(400000);
     }
-    void clear() override {
+    void clear() {
+      u8g2.clearBuffer();
+      u8g2.sendBuffer();
+    }
+    void clearBuffer() {
+      u8g2_prepare();
       u8g2.clearBuffer();
+    }
+    // font is the MicroOLED font type: 0 and 1 are text, 2 and 3 digits.
+    void draw(const char* title, int font, uint8_t x, uint8_t y) {
+      u8g2.setFont(font >= 2 ? u8g2_font_fur49_tn : u8g2_font_ncenB14_tr);
+      u8g2.drawUTF8(x, y, title);
+    }
+    void flush() {
+      TRACE_SCOPE(DISPLAY_FLUSH);
+      if (u8g2.isGray4()) {
+        u8g2.smoothGray4(0, 0, u8g2.getDisplayWidth(), u8g2.getDisplayHeight());
+      }
       u8g2.sendBuffer();
     }
-    void display(String title, int font, uint8_t x, uint8_t y) override {
-      startDisplay(u8g2_font_fur49_tn);
-      display_(title, x, y);
-      endDisplay();
+    uint8_t width() {
+      return u8g2.getDisplayWidth();
     }
-    void display(String title, int font) override {
-        display(title, font, 0, 0);
+    uint8_t height() {
+      return u8g2.getDisplayHeight();
     }
-    void displayNumber(String s) override {
-        // To reduce OLED burn-in, shift the digits (if possible) on the odd minutes.
+    void clearArea(uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+      uint8_t color = u8g2.getDrawColor();
+      u8g2.setDrawColor(0);
+      u8g2.drawBox(x, y, w, h);
+      u8g2.setDrawColor(color);
+    }
+    void drawColumn(uint8_t x, uint8_t y, uint8_t h, uint8_t fill) {
+      uint8_t color = u8g2.getDrawColor();
+      u8g2.setDrawColor(0);
+      u8g2.drawVLine(x, y, h);
+      u8g2.setDrawColor(color);
+      if (fill > 0) {
+        u8g2.drawVLine(x, y + h - fill, fill);
+      }
+    }
+    // Sends the tiles (8x8 pixels) that cover the area. Bars are axis aligned, so
+    // there is no smoothGray4() here.
+    void flushArea(uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+      TRACE_SCOPE(DISPLAY_FLUSH);
+      uint8_t tx = x / 8;
+      uint8_t ty = y / 8;
+      u8g2.updateDisplayArea(tx, ty, (x + w + 7) / 8 - tx, (y + h + 7) / 8 - ty);
+    }
+};
+#endif
+
+#ifdef OLED_SWITCHABLE
+class DisplayDriver {
+  public:
+    virtual const char* name() = 0;
+    virtual void startup() = 0;
+    virtual void clearBuffer() = 0;
+    virtual void draw(const char* title, int font, uint8_t x, uint8_t y) = 0;
+    virtual void flush() = 0;
+    virtual uint8_t width() = 0;
+    virtual uint8_t height() = 0;
+    virtual void clearArea(uint8_t x, uint8_t y, uint8_t w, uint8_t h) = 0;
+    virtual void drawColumn(uint8_t x, uint8_t y, uint8_t h, uint8_t fill) = 0;
+    virtual void flushArea(uint8_t x, uint8_t y, uint8_t w, uint8_t h) = 0;
+    virtual void clear() = 0;
+};
+
+template <class Driver>
+class VirtualDriver : public DisplayDriver {
+  private:
+    Driver driver;
+  public:
+    const char* name() override { return driver.name(); }
+    void startup() override { driver.startup(); }
+    void clearBuffer() override { driver.clearBuffer(); }
+    void draw(const char* title, int font, uint8_t x, uint8_t y) override { driver.draw(title, font, x, y); }
+    void flush() override { driver.flush(); }
+    uint8_t width() override { return driver.width(); }
+    uint8_t height() override { return driver.height(); }
+    void clearArea(uint8_t x, uint8_t y, uint8_t w, uint8_t h) override { driver.clearArea(x, y, w, h); }
+    void drawColumn(uint8_t x, uint8_t y, uint8_t h, uint8_t fill) override { driver.drawColumn(x, y, h, fill); }
+    void flushArea(uint8_t x, uint8_t y, uint8_t w, uint8_t h) override { driver.flushArea(x, y, w, h); }
+    void clear() override { driver.clear(); }
+};
+
+VirtualDriver<MicroOLEDDriver> microOLEDDriver;
+VirtualDriver<U8g2Driver>      u8g2Driver;
+
+class SwitchableDriver {
+  private:
+    DisplayDriver* driver = &microOLEDDriver;
+  public:
+    void select(DisplayDriver& d) { driver = &d; }
+    const char* name() { return driver->name(); }
+    void startup() { driver->startup(); }
+    void clearBuffer() { driver->clearBuffer(); }
+    void draw(const char* title, int font, uint8_t x, uint8_t y) { driver->draw(title, font, x, y); }
+    void flush() { driver->flush(); }
+    uint8_t width() { return driver->width(); }
+    uint8_t height() { return driver->height(); }
+    void clearArea(uint8_t x, uint8_t y, uint8_t w, uint8_t h) { driver->clearArea(x, y, w, h); }
+    void drawColumn(uint8_t x, uint8_t y, uint8_t h, uint8_t fill) { driver->drawColumn(x, y, h, fill); }
+    void flushArea(uint8_t x, uint8_t y, uint8_t w, uint8_t h) { driver->flushArea(x, y, w, h); }
+    void clear() { driver->clear(); }
+};
+#endif
+
+// The display API takes const char* and int, all formatting goes to stack buffers:
+// rendering doesn't touch the heap.
+template <class Driver>
+class Display : public Driver {
+  private:
+    static const size_t NUMBER_SIZE = 12;   // "-2147483648"
+    static const char* formatNumber(char* buf, int value) {
+      snprintf(buf, NUMBER_SIZE, "%d", value);
+      return buf;
+    }
+    // To reduce OLED burn-in, shift the digits (if possible) on the odd minutes.
+    static int numberX(size_t len) {
         int x = 0;
         if (Time.minute() % 2) {
-            const int MAX_DIGITS = 5;
-            if (s.length() < MAX_DIGITS) {
+            const size_t MAX_DIGITS = 5;
+            if (len < MAX_DIGITS) {
                 const int FONT_WIDTH = 12;
-                x += FONT_WIDTH * (MAX_DIGITS - s.length());
+                x += FONT_WIDTH * (MAX_DIGITS - len);
             }
         }
-        display(s, 3, x, 0);
+        return x;
     }
-    void publishJson() override {
+  public:
+    int       baseline = 0;
+    const int MAX_BASELINE = 16;
+
+    void display(const char* title, int font, uint8_t x, uint8_t y) {
+        this->clearBuffer();
+        this->draw(title, font, x, y);
+        this->flush();
+    }
+
+    void display(const char* title, int font) {
+        display(title, font, 0, 0);
+    }
+
+    void displayNumber(const char* s) {
+        display(s, 3, numberX(strlen(s)), 0);
+    }
+
+    void displayNumber(int value) {
+        char s[NUMBER_SIZE];
+        displayNumber(formatNumber(s, value));
+    }
+
+    void drawValueAndTime(int value, uint64_t elapsedMs) {
+      char timeStr[Utils::ELAPSED_TIME_SIZE];
+      drawValueAndTime(value, Utils::formatElapsedTime(timeStr, sizeof(timeStr), elapsedMs));
+    }
+
+    void drawValueAndTime(int value, const char* timeStr) {
+      char s[NUMBER_SIZE];
+      this->draw(formatNumber(s, value), 1, 0, baseline);
+      this->draw(timeStr, 1, 0, baseline + 16);
+      baseline++;
+      if (baseline > MAX_BASELINE) {
+        baseline = 0;
+      }
+    }
+
+    void publishJson() {
         String json("{");
-        JSonizer::addFirstSetting(json, "OLEDWrapperU8g2", "active");
+        JSonizer::addFirstSetting(json, "driver", this->name());
+        JSonizer::addSetting(json, "width", String(this->width()));
+        JSonizer::addSetting(json, "height", String(this->height()));
+        JSonizer::addSetting(json, "baseline", String(baseline));
+        JSonizer::addSetting(json, "MAX_BASELINE", String(MAX_BASELINE));
         json.concat("}");
         Particle.publish("OLED", json);
     }
-  };
+};
+
+#if defined(OLED_SWITCHABLE)
+typedef Display<SwitchableDriver> OLEDWrapper;
+#elif defined(OLED_SSD1327)
+typedef Display<U8g2Driver> OLEDWrapper;
+#else
+typedef Display<MicroOLEDDriver> OLEDWrapper;
+#endif
+OLEDWrapper oledWrapper;
+
+// Owns the display cadence. Components register a render callback with a target
+// period and a priority. tick() renders at most one frame per FRAME_BUDGET_MS:
+// the highest priority entry that is due draws into the cleared frame buffer and
+// the frame is flushed once. A callback returns false when it has nothing to show.
+// Partial entries (addPartial()) keep the frame buffer, they draw and flush only
+// their own area and redraw all of it when generation() changed.
+// Timed screens (splash, setup messages) are queued with show() and shown one
+// after the other for their duration instead of delay(), the registered entries
+// resume when the queue is empty.
+class RenderScheduler {
+  public:
+    typedef bool (*RenderFn)(OLEDWrapper& oled);
+    static const uint32_t FRAME_BUDGET_MS = 250;
+  private:
+    struct Entry {
+      RenderFn  fn;
+      uint32_t  periodMs;
+      uint8_t   priority;     // higher wins
+      bool      enabled;
+      bool      partial;
+      uint64_t  lastRender;
+    };
+    struct Screen {
+      const char* text;       // nullptr: keep what is on the panel
+      uint8_t     font;
+      uint32_t    ms;         // 0: until the next screen is queued
+    };
+    static const int      MAX_ENTRIES = 4;
+    static const int      MAX_SCREENS = 4;
+    static const uint32_t FPS_WINDOW_MS = 10 * 1000;
+
+    Entry     entries[MAX_ENTRIES];
+    int       numEntries = 0;
+    Screen    screens[MAX_SCREENS];
+    int       firstScreen = 0;
+    int       numScreens = 0;
+    bool      screenShown = false;
+    uint64_t  screenUntil = 0;
+    uint64_t  lastFrame = 0;
+    uint32_t  generation_ = 0;  // frame buffer clears
+
+    uint32_t  frames = 0;
+    uint32_t  deferred = 0;     // due entries that waited for a higher priority one
+    uint32_t  overBudget = 0;   // frames that took longer than FRAME_BUDGET_MS
+    uint32_t  lastFrameUs = 0;
+    uint32_t  maxFrameUs = 0;
+    uint64_t  fpsSince = 0;
+    uint32_t  fpsFrames = 0;
+    float     fps = 0;
+
+    void frameDone(uint64_t now, uint64_t startUs) {
+      lastFrameUs = Clock::micros64() - startUs;
+      if (lastFrameUs > maxFrameUs) {
+        maxFrameUs = lastFrameUs;
+      }
+      if (lastFrameUs > FRAME_BUDGET_MS * 1000) {
+        overBudget++;
+      }
+      lastFrame = now;
+      frames++;
+      fpsFrames++;
+      if (now - fpsSince >= FPS_WINDOW_MS) {
+        fps = fpsFrames * 1000.0f / (now - fpsSince);
+        fpsSince = now;
+        fpsFrames = 0;
+      }
+    }
+
+    bool renderEntry(Entry& e, uint64_t now) {
+      PERF_SCOPE(display);
+      uint64_t startUs = Clock::micros64();
+      if (!e.partial) {
+        oledWrapper.clearBuffer();
+        generation_++;
+      }
+      if (!e.fn(oledWrapper)) {
+        return false;
+      }
+      if (!e.partial) {
+        oledWrapper.flush();
+      }
+      frameDone(now, startUs);
+      return true;
+    }
+
+    void nextScreen() {
+      firstScreen = (firstScreen + 1) % MAX_SCREENS;
+      numScreens--;
+      screenShown = false;
+    }
+
+    void tickScreens(uint64_t now) {
+      // A screen without duration that was replaced before it came up is skipped.
+      while (!screenShown && screens[firstScreen].ms == 0 && numScreens > 1) {
+        nextScreen();
+      }
+      Screen& s = screens[firstScreen];
+      if (!screenShown) {
+        generation_++;
+        if (s.text != nullptr) {
+          PERF_SCOPE(display);
+          uint64_t startUs = Clock::micros64();
+          oledWrapper.display(s.text, s.font);
+          frameDone(now, startUs);
+        }
+        screenShown = true;
+        screenUntil = now + s.ms;
+        return;
+      }
+      if (now < screenUntil || (s.ms == 0 && numScreens == 1)) {
+        return;
+      }
+      nextScreen();
+      if (numScreens > 0) {
+        tickScreens(now);
+      } else {
+        clear();
+      }
+    }
+
+  public:
+    // Returns the id for setEnabled(), -1 if all entries are taken.
+    int add(RenderFn fn, uint32_t periodMs, uint8_t priority, bool enabled = true) {
+      if (numEntries == MAX_ENTRIES) {
+        return -1;
+      }
+      entries[numEntries] = Entry { fn, periodMs, priority, enabled, false, 0 };
+      return numEntries++;
+    }
+
+    int addPartial(RenderFn fn, uint32_t periodMs, uint8_t priority) {
+      int id = add(fn, periodMs, priority);
+      if (id >= 0) {
+        entries[id].partial = true;
+      }
+      return id;
+    }
+
+    uint32_t generation() {
+      return generation_;
+    }
+
+    void setEnabled(int id, bool enabled) {
+      if (id >= 0 && id < numEntries) {
+        entries[id].enabled = enabled;
+      }
+    }
+
+    // Returns false if the queue is full.
+    bool show(const char* text, uint8_t font, uint32_t ms) {
+      if (numScreens == MAX_SCREENS) {
+        return false;
+      }
+      screens[(firstScreen + numScreens) % MAX_SCREENS] = Screen { text, font, ms };
+      numScreens++;
+      return true;
+    }
+
+    void clear() {
+      uint64_t startUs = Clock::micros64();
+      oledWrapper.clear();
+      generation_++;
+      frameDone(Clock::millis64(), startUs);
+    }
+
+    void tick() {
+      uint64_t now = Clock::millis64();
+      if (numScreens > 0) {
+        tickScreens(now);
+        return;
+      }
+      if (now - lastFrame < FRAME_BUDGET_MS) {
+        return;
+      }
+      // By priority, until one of the due entries has something to show.
+      bool due[MAX_ENTRIES];
+      int numDue = 0;
+      for (int i = 0; i < numEntries; i++) {
+        due[i] = entries[i].enabled && now - entries[i].lastRender >= entries[i].periodMs;
+        numDue += due[i];
+      }
+      while (numDue > 0) {
+        int best = -1;
+        for (int i = 0; i < numEntries; i++) {
+          if (due[i] && (best < 0 || entries[i].priority > entries[best].priority)) {
+            best = i;
+          }
+        }
+        due[best] = false;
+        numDue--;
+        entries[best].lastRender = now;
+        if (renderEntry(entries[best], now)) {
+          deferred += numDue;
+          return;
+        }
+      }
+    }
+
+    String getJson() {
+      String json("{");
+      JSonizer::addFirstSetting(json, "FRAME_BUDGET_MS", String(FRAME_BUDGET_MS));
+      JSonizer::addSetting(json, "fps", String(fps));
+      JSonizer::addSetting(json, "frames", String(frames));
+      JSonizer::addSetting(json, "lastFrameUs", String(lastFrameUs));
+      JSonizer::addSetting(json, "maxFrameUs", String(maxFrameUs));
+      JSonizer::addSetting(json, "overBudget", String(overBudget));
+      JSonizer::addSetting(json, "deferred", String(deferred));
+      JSonizer::addSetting(json, "entries", String(numEntries));
+      JSonizer::addSetting(json, "queuedScreens", String(numScreens));
+      json.concat("}");
+      return json;
+    }
+};
+RenderScheduler renderScheduler;
+
+// Strip chart of the per publish interval maxima in the bottom HEIGHT rows, on
+// panels with room for it (the 128x128 SSD1327). The chart sweeps: a sample is
+// drawn at the cursor column and the cursor moves right by one column, wrapping
+// around, with an empty column after the newest sample. So an update rewrites
+// only the tiles of the new columns instead of the whole frame. (The SSD1306 and
+// SSD1327 scroll commands run continuously off the frame clock, they can't
+// step by one column.)
+class StripChart {
+  public:
+    static const uint8_t HEIGHT = 64;
+    static const uint8_t WIDTH = 128;
+  private:
+    uint8_t   fill[WIDTH] = {};           // bar heights, indexed by column
+    uint8_t   cursor = 0;                 // column of the next sample
+    uint8_t   pending = 0;                // samples not drawn yet
+    uint32_t  generation = UINT32_MAX;    // see RenderScheduler::generation()
+
+    void drawColumn(OLEDWrapper& oled, uint8_t x, uint8_t y) {
+      oled.drawColumn(x, y, HEIGHT, x == cursor ? 0 : fill[x]);
+    }
+  public:
+    static bool fits(OLEDWrapper& oled) {
+      return oled.width() >= WIDTH && oled.height() >= 2 * HEIGHT;
+    }
+
+    void add(int value, int maxValue) {
+      if (value < 0) {
+        value = 0;
+      } else if (value > maxValue) {
+        value = maxValue;
+      }
+      fill[cursor] = maxValue > 0 ? value * HEIGHT / maxValue : 0;
+      cursor = (cursor + 1) % WIDTH;
+      if (pending < WIDTH) {
+        pending++;
+      }
+    }
+
+    bool render(OLEDWrapper& oled, uint32_t gen) {
+      if (!fits(oled)) {
+        return false;
+      }
+      uint8_t y = oled.height() - HEIGHT;
+      if (gen != generation) {
+        generation = gen;
+        pending = 0;
+        for (int x = 0; x < WIDTH; x++) {
+          drawColumn(oled, x, y);
+        }
+        oled.flushArea(0, y, WIDTH, HEIGHT);
+        return true;
+      }
+      if (pending == 0) {
+        return false;
+      }
+      // The new columns and the empty one at the cursor.
+      int first = (cursor + WIDTH - pending) % WIDTH;
+      for (int i = 0; i <= pending; i++) {
+        drawColumn(oled, (first + i) % WIDTH, y);
+      }
+      if (first + pending < WIDTH) {
+        oled.flushArea(first, y, pending + 1, HEIGHT);
+      } else {
+        oled.flushArea(first, y, WIDTH - first, HEIGHT);
+        oled.flushArea(0, y, cursor + 1, HEIGHT);
+      }
+      pending = 0;
+      return true;
+    }
+};
+
+// Storage of the OfflineStore: the emulated EEPROM of the Photon, which does its
+// own wear levelling. A storage has SIZE in bytes and get()/put() of a value at
+// a byte address like EEPROM. The host tests use a file instead (test/file_storage.h).
+struct EEPROMStorage {
+  static const int SIZE = EEPROM_SIZE;
+  template <class T> void get(int address, T& t) {
+    EEPROM.get(address, t);
+  }
+  template <class T> void put(int address, const T& t) {
+    EEPROM.put(address, t);
+  }
+};
+
+// Vibration records that could not be published, kept in the Storage and
+// published in batches once the cloud is back. Record n goes to slot
+// n % NUM_SLOTS, so the oldest records are overwritten when the store is full.
+// The newest record is found by a scan in begin(), the sequence number of the
+// last published record is kept in the header, so both survive a reboot.
+// A power cut can leave a record or the sequence number half written: records
+// carry a CRC-8 and are skipped when it doesn't match, the sent sequence number
+// is stored with its complement and is reset (everything is replayed again)
+// when they don't match. RAM use is the few counters, independent of NUM_SLOTS.
+template <class Storage = EEPROMStorage>
+class OfflineStore {
+  private:
+    struct Sent {
+      uint32_t seq;
+      uint32_t check;       // ~seq
+    };
+    struct Header {
+      uint32_t magic;
+      Sent     sent;
+    };
+    struct Record {
+      uint32_t seq;         // EMPTY_SEQ: slot never written
+      uint32_t time;
+      uint16_t value;
+      uint8_t  button;
+      uint8_t  crc;         // of the bytes before
+    };
+    static const uint32_t MAGIC = 0x56494232;   // "VIB2"
+    static const uint32_t EMPTY_SEQ = 0xFFFFFFFF;
+    static const int      RECORDS_START = sizeof(Header);
+    static const int      NUM_SLOTS = (Storage::SIZE - sizeof(Header)) / sizeof(Record);
+    static const int      RECORDS_PER_BATCH = 12;   // stay below the publish size limit
+    const uint64_t        REPLAY_RATE_IN_MS = 2000;
+
+    Storage  storage;
+    uint32_t nextSeq = 1;
+    uint32_t sentSeq = 0;
+    uint64_t lastReplay = 0;
+    uint32_t damaged = 0;   // records skipped by begin()
+
+    static uint8_t crc8(const Record& r) {
+      const uint8_t* p = (const uint8_t*)&r;
+      uint8_t crc = 0;
+      for (size_t i = 0; i < offsetof(Record, crc); i++) {
+        crc ^= p[i];
+        for (int bit = 0; bit < 8; bit++) {
+          crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+      }
+      return crc;
+    }
+    int address(uint32_t seq) {
+      return RECORDS_START + (seq % NUM_SLOTS) * sizeof(Record);
+    }
+    uint32_t firstPending() {
+      uint32_t first = sentSeq + 1;
+      if (nextSeq > NUM_SLOTS && first < nextSeq - NUM_SLOTS) {
+        first = nextSeq - NUM_SLOTS;    // overwritten
+      }
+      return first;
+    }
+    void writeSent() {
+      Sent sent = { sentSeq, ~sentSeq };
+      storage.put(offsetof(Header, sent), sent);
+    }
+
+  public:
+    static const int CAPACITY = NUM_SLOTS;
+
+    OfflineStore(Storage s = Storage()) : storage(s) {}
+
+    void begin() {
+      Header h;
+      storage.get(0, h);
+      if (h.magic != MAGIC) {
+        Record r;
+        memset(&r, 0xFF, sizeof(r));
+        for (int i = 0; i < NUM_SLOTS; i++) {
+          storage.put(RECORDS_START + i * sizeof(Record), r);
+        }
+        h.magic = MAGIC;
+        h.sent = { 0, ~0u };
+        storage.put(0, h);
+      }
+      sentSeq = h.sent.check == ~h.sent.seq ? h.sent.seq : 0;
+      uint32_t maxSeq = 0;
+      damaged = 0;
+      for (int i = 0; i < NUM_SLOTS; i++) {
+        Record r;
+        storage.get(RECORDS_START + i * sizeof(Record), r);
+        if (r.seq == EMPTY_SEQ) {
+          continue;
+        }
+        if (r.crc != crc8(r) || r.seq % NUM_SLOTS != (uint32_t)i) {
+          damaged++;
+        } else if (r.seq > maxSeq) {
+          maxSeq = r.seq;
+        }
+      }
+      nextSeq = maxSeq + 1;
+      if (sentSeq > maxSeq) {
+        sentSeq = maxSeq;
+      }
+    }
+
+    void append(time_t time, uint16_t value, bool button) {
+      Record r = { nextSeq, (uint32_t)time, value, (uint8_t)(button ? 1 : 0), 0 };
+      r.crc = crc8(r);
+      storage.put(address(nextSeq), r);
+      nextSeq++;
+    }
+
+    uint32_t pending() {
+      return nextSeq - firstPending();
+    }
+
+    // Publish the next batch of records, at most every REPLAY_RATE_IN_MS.
+    // Damaged records in the batch are left out.
+    void replay() {
+      if (pending() == 0 || !Particle.connected() ||
+            Clock::millis64() - lastReplay < REPLAY_RATE_IN_MS) {
+        return;
+      }
+      lastReplay = Clock::millis64();
+      String json("[");
+      uint32_t seq = firstPending();
+      bool first = true;
+      for (int i = 0; i < RECORDS_PER_BATCH && seq < nextSeq; i++, seq++) {
+        Record r;
+        storage.get(address(seq), r);
+        if (r.seq != seq || r.crc != crc8(r)) {
+          continue;
+        }
+        if (!first) {
+          json.concat(",");
+        }
+        first = false;
+        json.concat("{");
+        JSonizer::addFirstSetting(json, "t", String((unsigned long)r.time));
+        JSonizer::addSetting(json, "max_in_publish_interval", String(r.value));
+        JSonizer::addSetting(json, "b", r.button ? "150" : "0");
+        json.concat("}");
+      }
+      json.concat("]");
+      if (first || Particle.publish("vibration offline", json)) {
+        sentSeq = seq - 1;
+        writeSent();
+      }
+    }
+
+    String getJson() {
+      String json("{");
+      JSonizer::addFirstSetting(json, "NUM_SLOTS", String(NUM_SLOTS));
+      JSonizer::addSetting(json, "nextSeq", String((unsigned long)nextSeq));
+      JSonizer::addSetting(json, "sentSeq", String((unsigned long)sentSeq));
+      JSonizer::addSetting(json, "pending", String((unsigned long)pending()));
+      JSonizer::addSetting(json, "damaged", String((unsigned long)damaged));
+      json.concat("}");
+      return json;
+    }
+};
+OfflineStore<> offlineStore;
+
+// Device parameters of the sampling pipeline. FixedProfile has them as
+// compile-time constants, RuntimeProfile holds them for unknown devices.
+template <pin_t Pin, uint16_t Baseline, uint16_t ZeroCorrection, uint16_t MaxValue>
+struct FixedProfile {
+  static constexpr pin_t    pin()             { return Pin; }
+  static constexpr uint16_t baseline()        { return Baseline; }
+  static constexpr uint16_t zeroCorrection()  { return ZeroCorrection; }
+  static constexpr uint16_t maxValue()        { return MaxValue; }
+};
+
+struct RuntimeProfile {
+  pin_t    pin_;
+  uint16_t baseline_;
+  uint16_t zeroCorrection_;
+  uint16_t maxValue_;
+  pin_t    pin() const             { return pin_; }
+  uint16_t baseline() const        { return baseline_; }
+  uint16_t zeroCorrection() const  { return zeroCorrection_; }
+  uint16_t maxValue() const        { return maxValue_; }
+};
+
+// Per-channel state as struct of arrays: the sampling loop only walks pin[]
+// and rawMax[], and the publish/display code only the arrays it needs.
+// Channel 0 uses the device profile of the SensorPipeline, the others are
+// configured at runtime (see SensorHandler::setChannels() and
+// SensorHandler::setChannelParams()).
+struct SensorChannels {
+  static const int MAX_CHANNELS = 4;
+  int      count = 1;
+  pin_t    pin[MAX_CHANNELS] = { A0, A1, A2, A3 };
+  uint16_t baseline[MAX_CHANNELS] = {};
+  uint16_t zeroCorrection[MAX_CHANNELS] = {};
+  uint16_t maxValue[MAX_CHANNELS] = {};
+  uint16_t rawMax[MAX_CHANNELS] = {};
+  uint16_t value[MAX_CHANNELS] = {};            // max minus baseline of the last burst
+  uint16_t maxInPublishInterval[MAX_CHANNELS] = {};
+  uint64_t lastMillisOfMax[MAX_CHANNELS] = {};
+  time_t   lastTimeOfMax[MAX_CHANNELS] = {};    // formatted only when published
+
+  // Optional fixed point filter ahead of peak detection, see filterBurst().
+  uint8_t  decimation = 1;                      // 1: no decimation
+  uint8_t  envelopeShift = 0;                   // envelope release, 0: no envelope follower
+  int32_t  acc[MAX_CHANNELS] = {};
+  int32_t  dc[MAX_CHANNELS] = {};               // Q16
+  uint16_t dcCount[MAX_CHANNELS] = {};          // samples in dc[] while it settles
+  int32_t  env[MAX_CHANNELS] = {};              // Q16
+
+  bool filtered() const {
+    return decimation > 1 || envelopeShift > 0;
+  }
+  void resetFilter() {
+    for (int c = 0; c < MAX_CHANNELS; c++) {
+      dc[c] = 0;
+      dcCount[c] = 0;
+      env[c] = 0;
+    }
+  }
+
+  // Interleaved burst like SensorPipeline::sampleMax(), but sets rawMax[] to
+  // the max of the filtered readings:
+  // - CIC decimator (order 1): mean of `decimation` readings
+  // - DC tracker (single pole low pass), the high pass is the difference to it.
+  //   It starts as the mean of the samples so far, so the envelope does not
+  //   read the offset of the first sample until the low pass has settled.
+  // - envelope follower on the rectified high pass. The attack is smoothed,
+  //   so a single ADC glitch does not set the max, the release is slow.
+  // The output is the DC level plus the envelope, which has the scale of the
+  // raw readings, so baseline and zero correction still apply.
+  void filterBurst(int numSamples) {
+    const int DC_SHIFT = 12;
+    const int ATTACK_SHIFT = 2;
+    int n = 0;
+    for (int c = 0; c < count; c++) {
+      acc[c] = 0;
+      rawMax[c] = 0;
+    }
+    for (int i = 0; i < numSamples; i++) {
+      for (int c = 0; c < count; c++) {
+        acc[c] += analogRead(pin[c]);
+      }
+      if (++n < decimation) {
+        continue;
+      }
+      n = 0;
+      for (int c = 0; c < count; c++) {
+        int32_t x = ((acc[c] << 8) / decimation) << 8;
+        int32_t y = x;
+        acc[c] = 0;
+        if (envelopeShift > 0) {
+          if (dcCount[c] < (1 << DC_SHIFT)) {
+            dc[c] += (x - dc[c]) / ++dcCount[c];
+          } else {
+            dc[c] += (x - dc[c]) >> DC_SHIFT;
+          }
+          int32_t a = x - dc[c];
+          if (a < 0) {
+            a = -a;
+          }
+          if (a > env[c]) {
+            env[c] += (a - env[c]) >> ATTACK_SHIFT;
+          } else {
+            env[c] -= env[c] >> envelopeShift;
+          }
+          y = dc[c] + env[c];
+        }
+        uint16_t v = y >> 16;
+        if (v > rawMax[c]) {
+          rawMax[c] = v;
+        }
+      }
+    }
+  }
+};
 
-OLEDWrapper* oledWrapper = nullptr;
+class SensorPipelineBase {
+  public:
+    virtual ~SensorPipelineBase() {}
+    // Interleaved burst of numSamples readings per channel, sets ch.value[]
+    // to the max minus the baseline.
+    virtual void sampleMax(int numSamples, SensorChannels& ch) = 0;
+    virtual uint16_t baseline() = 0;
+    virtual uint16_t zeroCorrection() = 0;
+    virtual uint16_t maxValue() = 0;
+};
+
+template <class Profile>
+class SensorPipeline : public SensorPipelineBase {
+  private:
+    Profile profile;
+  public:
+    SensorPipeline(const Profile& p = Profile()) : profile(p) {}
+    void sampleMax(int numSamples, SensorChannels& ch) override {
+      const pin_t pin = profile.pin();
+      const int count = ch.count;
+      uint16_t m = 0;
+      if (ch.filtered()) {
+        ch.filterBurst(numSamples);
+        m = ch.rawMax[0];
+      } else {
+        for (int c = 1; c < count; c++) {
+          ch.rawMax[c] = 0;
+        }
+        for (int i = 0; i < numSamples; i++) {
+          uint16_t v = analogRead(pin);
+          if (v > m) {
+            m = v;
+          }
+          for (int c = 1; c < count; c++) {
+            v = analogRead(ch.pin[c]);
+            if (v > ch.rawMax[c]) {
+              ch.rawMax[c] = v;
+            }
+          }
+        }
+      }
+      ch.value[0] = m < profile.baseline() ? 0 : m - profile.baseline();
+      for (int c = 1; c < count; c++) {
+        ch.value[c] = ch.rawMax[c] < ch.baseline[c] ? 0 : ch.rawMax[c] - ch.baseline[c];
+      }
+    }
+    uint16_t baseline() override {
+      return profile.baseline();
+    }
+    uint16_t zeroCorrection() override {
+      return profile.zeroCorrection();
+    }
+    uint16_t maxValue() override {
+      return profile.maxValue();
+    }
+};
+
+template <int I>
+using DeviceProfile = FixedProfile<A0, DEVICES[I].baseline, DEVICES[I].zeroCorrection, DEVICES[I].maxValue>;
+
+// Pipeline for DEVICES[device], compiled for it if fixedProfile is set.
+template <int I = 0>
+SensorPipelineBase* createSensorPipeline(int device) {
+  if constexpr (I < NUM_DEVICES) {
+    if constexpr (DEVICES[I].fixedProfile) {
+      if (device == I) {
+        return StaticArena::create<SensorPipeline<DeviceProfile<I>>>();
+      }
+    }
+    return createSensorPipeline<I + 1>(device);
+  } else {
+    const DeviceParams& params = device < 0 ? UNKNOWN_DEVICE : DEVICES[device];
+    return StaticArena::create<SensorPipeline<RuntimeProfile>>(RuntimeProfile { A0,
+                  params.baseline, params.zeroCorrection, params.maxValue });
+  }
+}
+
+// Looks up the device once.
+SensorPipelineBase* createSensorPipeline() {
+  return createSensorPipeline(Utils::getDeviceIndex());
+}
 
 class SensorHandler {
   private:
-    uint16_t applyBaseline(uint16_t v) {
-      if (v < Utils::getDeviceBaseline()) {
-        return 0;
+    SensorPipelineBase* pipeline = nullptr;   // created on first use, see getPipeline()
+    SensorChannels      channels;
+    StripChart          chart;
+
+    SensorPipelineBase& getPipeline() {
+      if (pipeline == nullptr) {
+        pipeline = createSensorPipeline();
+        for (int c = 0; c < SensorChannels::MAX_CHANNELS; c++) {
+          channels.baseline[c] = pipeline->baseline();
+          channels.zeroCorrection[c] = pipeline->zeroCorrection();
+          channels.maxValue[c] = pipeline->maxValue();
+        }
       }
-      return v - Utils::getDeviceBaseline();
+      return *pipeline;
+    }
+    SensorChannels& getChannels() {
+      getPipeline();
+      return channels;
     }
 
-    uint16_t          max_in_publish_interval = 0;
-    long unsigned int last_millis_of_max = 0;
     bool              buttonStateInPublishInterval = LOW;
+    uint32_t          pressesInPublishInterval = 0;
+
+    // Sample blocks (bursts) and publish intervals are numbered, the button
+    // interrupt tags the first edge of a press with both (Button::blockStarted()).
+    uint32_t          blocks = 0;             // number of the last block
+    uint32_t          publishIntervals = 0;   // number of the current interval
+
+    void checkButton() {
+      uint32_t presses = button.checkState();
+      if (presses > 0) {
+        // A press still bouncing when the interval was published is counted in
+        // the next one, its last_press_interval is the one it started in.
+        pressesInPublishInterval += presses;
+        buttonStateInPublishInterval = HIGH;
+      }
+      if (button.isPressed()) {
+        buttonStateInPublishInterval = HIGH;
+      }
+    }
 
-    int getZeroCorrected() {
-        if (max_in_publish_interval > Utils::getDeviceZeroCorrection()) {
-          return max_in_publish_interval - Utils::getDeviceZeroCorrection();
+    int getZeroCorrected(int c) {
+        SensorChannels& ch = getChannels();
+        if (ch.maxInPublishInterval[c] > ch.zeroCorrection[c]) {
+          return ch.maxInPublishInterval[c] - ch.zeroCorrection[c];
         }
         return 0;
     }
-    void do_publish(unsigned long elapsedMillis) {
+    int getZeroCorrected() {
+        return getZeroCorrected(0);
+    }
+    void do_publish(uint64_t elapsedMillis) {
+        TRACE_SCOPE(PUBLISH);
         String json("{");
         JSonizer::addFirstSetting(json, "b", buttonStateInPublishInterval == HIGH ?
                                                   "150" : "0");
+        JSonizer::addSetting(json, "presses", String(pressesInPublishInterval));
         JSonizer::addSetting(json, "max_in_publish_interval", String(getZeroCorrected()));
-        JSonizer::addSetting(json, "elapsedSeconds", String(elapsedMillis / 1000));
+        for (int c = 1; c < channels.count; c++) {
+          JSonizer::addSetting(json, "max_in_publish_interval_" + String(c), String(getZeroCorrected(c)));
+        }
+        JSonizer::addSetting(json, "elapsedSeconds", JSonizer::toString(elapsedMillis / 1000));
         json.concat("}");
-        Particle.publish("vibration", json);
+        if (!Particle.connected() || !Particle.publish("vibration", json)) {
+          offlineStore.append(Time.now(), getZeroCorrected(), buttonStateInPublishInterval == HIGH);
+        }
+        chart.add(getZeroCorrected(), chartRange());
     }
 
-    uint16_t      max_A0 = 0;
-    const int     NUM_SAMPLES = 1000;
     const int     PIEZO_PIN_0 = A0;
-    String        last_time_of_max;
 
-    void getVoltages() {
-      max_A0 = 0;
-      for (int i = 0; i < NUM_SAMPLES; i++) {
-        uint16_t piezoV = analogRead(PIEZO_PIN_0);
-        if (piezoV > max_A0) {
-          max_A0 = piezoV;
+    // Adaptive sampling: while the machine is idle, take a short burst every
+    // IDLE_PERIOD_MS. Once the signal rises ACTIVITY_THRESHOLD above the zero
+    // correction, take long bursts on every loop until it has been quiet for
+    // ACTIVE_HOLD_MS.
+    int             idleSamples = 100;
+    int             activeSamples = 1000;
+    const uint16_t  ACTIVITY_THRESHOLD = 25;
+    const uint64_t  IDLE_PERIOD_MS = 50;
+    const uint64_t  ACTIVE_HOLD_MS = 60 * 1000;
+    bool            activeMode = true;    // don't miss a machine that is already running
+    uint64_t        modeSince = 0;
+    uint64_t        lastActivity = 0;
+    uint64_t        lastBurst = 0;
+    uint64_t        idleMillis = 0;       // residency, not counting the current mode
+    uint64_t        activeMillis = 0;
+    uint32_t        modeSwitches = 0;
+    uint64_t        waitMillis = 0;       // spent in waitForNextBurst()
+
+    void updateMode(uint64_t now) {
+      bool active = activeMode;
+      bool activity = false;
+      for (int c = 0; c < channels.count; c++) {
+        if (channels.value[c] > channels.zeroCorrection[c] + ACTIVITY_THRESHOLD) {
+          activity = true;
         }
       }
-      max_A0 = applyBaseline(max_A0);
-      if (max_A0 > Utils::getMaxVibrationValue()) {
-        max_A0 = Utils::getMaxVibrationValue();
-        if (! in_publishing_window()) {
-          last_millis_of_max = millis();
-          last_time_of_max = timeSupport.now();
+      if (activity) {
+        lastActivity = now;
+        active = true;
+      } else if (now - lastActivity > ACTIVE_HOLD_MS) {
+        active = false;
+      }
+      if (active != activeMode) {
+        if (activeMode) {
+          activeMillis += now - modeSince;
+        } else {
+          idleMillis += now - modeSince;
         }
+        modeSince = now;
+        activeMode = active;
+        modeSwitches++;
+      }
+    }
+
+    void getVoltages() {
+      uint64_t now = Clock::millis64();
+      if (!activeMode && now - lastBurst < IDLE_PERIOD_MS) {
+        return;   // keep the values of the last burst
       }
-      if (max_A0 > max_in_publish_interval) {
-        max_in_publish_interval = max_A0;
+      lastBurst = now;
+      PERF_SCOPE(getVoltages);
+      TRACE_SCOPE(SAMPLE);
+      SensorPipelineBase& pipeline = getPipeline();
+      blocks++;
+      button.blockStarted(blocks);
+      pipeline.sampleMax(activeMode ? activeSamples : idleSamples, channels);
+      button.blockEnded(blocks);
+      updateMode(now);
+      for (int c = 0; c < channels.count; c++) {
+        if (channels.value[c] > channels.maxValue[c]) {
+          channels.value[c] = channels.maxValue[c];
+          if (! in_publishing_window(c)) {
+            channels.lastMillisOfMax[c] = now;
+            channels.lastTimeOfMax[c] = Time.now();
+          }
+        }
+        if (channels.value[c] > channels.maxInPublishInterval[c]) {
+          channels.maxInPublishInterval[c] = channels.value[c];
+        }
       }
     }
 
-    unsigned long last_publish_time = 0;
-    const int     PUBLISH_RATE_IN_SECONDS = 5;
+    uint64_t      last_publish_time = 0;
 
-    void publish_max(unsigned long elapsedMillis) {
-      unsigned long now = millis();
-      if (now - last_publish_time > PUBLISH_RATE_IN_SECONDS * 1000) {
+    void publish_max(uint64_t elapsedMillis) {
+      PERF_SCOPE(publishMax);
+      const uint64_t PUBLISH_INTERVAL_MS = 5000;
+      uint64_t now = Clock::millis64();
+      if (now - last_publish_time > PUBLISH_INTERVAL_MS) {
         do_publish(elapsedMillis);
-        last_publish_time = millis();
-        max_in_publish_interval = 0;
+        last_publish_time = Clock::millis64();
+        for (int c = 0; c < channels.count; c++) {
+          channels.maxInPublishInterval[c] = 0;
+        }
         buttonStateInPublishInterval = LOW;
+        pressesInPublishInterval = 0;
+        publishIntervals++;
+        button.intervalStarted(publishIntervals);
       }
     }
 
-    bool in_publishing_window() {
-      const unsigned long TWO_HOURS_IN_MS = 1000 * 60 * 60 * 2;
-      return ((last_millis_of_max > 0) && (millis() - last_millis_of_max < TWO_HOURS_IN_MS));
+    bool in_publishing_window(int c = 0) {
+      const uint64_t TWO_HOURS_IN_MS = 1000 * 60 * 60 * 2;
+      uint64_t lastMillisOfMax = channels.lastMillisOfMax[c];
+      return ((lastMillisOfMax > 0) && (Clock::millis64() - lastMillisOfMax < TWO_HOURS_IN_MS));
     }
 
     String getJson() {
+      SensorChannels& ch = getChannels();
       String json("{");
-      JSonizer::addFirstSetting(json, "last_time_of_max", last_time_of_max);
+      JSonizer::addFirstSetting(json, "last_time_of_max",
+                                ch.lastTimeOfMax[0] == 0 ? "" : timeSupport.timeStr(ch.lastTimeOfMax[0]));
       JSonizer::addSetting(json, "PIEZO_PIN_0", String(PIEZO_PIN_0));
-      JSonizer::addSetting(json, "NUM_SAMPLES", String(NUM_SAMPLES));
-      JSonizer::addSetting(json, "max_A0", String(max_A0));
+      JSonizer::addSetting(json, "numChannels", String(ch.count));
+      for (int c = 1; c < ch.count; c++) {
+        JSonizer::addSetting(json, "baseline_" + String(c), String(ch.baseline[c]));
+        JSonizer::addSetting(json, "zeroCorrection_" + String(c), String(ch.zeroCorrection[c]));
+        JSonizer::addSetting(json, "maxValue_" + String(c), String(ch.maxValue[c]));
+      }
+      JSonizer::addSetting(json, "decimation", String(ch.decimation));
+      JSonizer::addSetting(json, "envelopeShift", String(ch.envelopeShift));
+      JSonizer::addSetting(json, "idleSamples", String(idleSamples));
+      JSonizer::addSetting(json, "activeSamples", String(activeSamples));
+      JSonizer::addSetting(json, "activeMode", JSonizer::toString(activeMode));
+      JSonizer::addSetting(json, "idleSeconds", JSonizer::toString(getIdleMillis() / 1000));
+      JSonizer::addSetting(json, "activeSeconds", JSonizer::toString(getActiveMillis() / 1000));
+      JSonizer::addSetting(json, "modeSwitches", String(modeSwitches));
+      JSonizer::addSetting(json, "waitSeconds", JSonizer::toString(waitMillis / 1000));
+      JSonizer::addSetting(json, "max_A0", String(ch.value[0]));
       JSonizer::addSetting(json, "in_publishing_window()", String(JSonizer::toString(in_publishing_window())));
       JSonizer::addSetting(json, "Utils::getMaxVibrationValue()", String(Utils::getMaxVibrationValue()));
-      JSonizer::addSetting(json, "last_millis_of_max", String(last_millis_of_max));
+      JSonizer::addSetting(json, "chartRange", String(chartRange()));
+      JSonizer::addSetting(json, "last_millis_of_max", JSonizer::toString(ch.lastMillisOfMax[0]));
+      JSonizer::addSetting(json, "blocks", String(blocks));
+      JSonizer::addSetting(json, "publishIntervals", String(publishIntervals));
+      JSonizer::addSetting(json, "presses", String(button.getPresses()));
+      JSonizer::addSetting(json, "last_press_block", String(button.lastPressBlock()));
+      JSonizer::addSetting(json, "last_press_in_block", JSonizer::toString(button.lastPressInBlock()));
+      JSonizer::addSetting(json, "last_press_interval", String(button.lastPressInterval()));
+      JSonizer::addSetting(json, "buttonOverflows", String(button.getOverflows()));
       json.concat("}");
       return json;
     }
+    uint64_t getIdleMillis() {
+      return idleMillis + (activeMode ? 0 : Clock::millis64() - modeSince);
+    }
+    uint64_t getActiveMillis() {
+      return activeMillis + (activeMode ? Clock::millis64() - modeSince : 0);
+    }
   public:
     SensorHandler() {
       pinMode(PIEZO_PIN_0, INPUT);
     }
 
+    // Full scale of the chart, the zero corrected max value. Without a sensor
+    // (unknown devices) the zero correction is at the max value, then the
+    // chart uses Utils::getMaxVibrationValue().
+    int chartRange() {
+      SensorChannels& ch = getChannels();
+      int range = ch.maxValue[0] - ch.zeroCorrection[0];
+      if (range <= 0) {
+        range = Utils::getMaxVibrationValue();
+      }
+      return range > 0 ? range : 1;
+    }
+
+    // command: "<idle samples>,<active samples>"
+    int setSamples(String command) {
+      int comma = command.indexOf(',');
+      if (comma < 0) {
+        return -1;
+      }
+      int idle = idleSamples;
+      int active = activeSamples;
+      if (Utils::setInt(command.substring(0, comma), idle, 10, 5000) < 0 ||
+          Utils::setInt(command.substring(comma + 1), active, 10, 5000) < 0) {
+        return -1;
+      }
+      idleSamples = idle;
+      activeSamples = active;
+      return 1;
+    }
+
+    // command: number of channels, sampled on A0, A1, ... Additional
+    // channels start with the baseline, zero correction and max of channel 0,
+    // see setChannelParams().
+    int setChannels(String command) {
+      int count = channels.count;
+      if (Utils::setInt(command, count, 1, SensorChannels::MAX_CHANNELS) < 0) {
+        return -1;
+      }
+      for (int c = channels.count; c < count; c++) {
+        pinMode(channels.pin[c], INPUT);
+        channels.maxInPublishInterval[c] = 0;
+        channels.lastMillisOfMax[c] = 0;
+        channels.lastTimeOfMax[c] = 0;
+      }
+      channels.count = count;
+      return 1;
+    }
+
+    // command: "<channel>,<baseline>,<zero correction>,<max>" for the channels
+    // 1, 2 and 3, also before they are turned on with setChannels(). Channel 0
+    // keeps the parameters of the device profile.
+    int setChannelParams(String command) {
+      SensorChannels& ch = getChannels();     // the pipeline sets the defaults first
+      const int lower[4] = { 1, 0, 0, 0 };
+      const int upper[4] = { SensorChannels::MAX_CHANNELS - 1, 4095, 4095, 4095 };
+      int values[4];
+      int from = 0;
+      for (int i = 0; i < 4; i++) {
+        int comma = command.indexOf(',', from);
+        if ((comma < 0) != (i == 3)) {
+          return -1;
+        }
+        String field = comma < 0 ? command.substring(from) : command.substring(from, comma);
+        if (Utils::setInt(field, values[i], lower[i], upper[i]) < 0) {
+          return -1;
+        }
+        from = comma + 1;
+      }
+      int c = values[0];
+      ch.baseline[c] = values[1];
+      ch.zeroCorrection[c] = values[2];
+      ch.maxValue[c] = values[3];
+      return 1;
+    }
+
+    // command: "<decimation>,<envelope release shift>", "1,0" turns the filter off
+    int setFilter(String command) {
+      int comma = command.indexOf(',');
+      if (comma < 0) {
+        return -1;
+      }
+      int decimation = channels.decimation;
+      int envelopeShift = channels.envelopeShift;
+      if (Utils::setInt(command.substring(0, comma), decimation, 1, 64) < 0 ||
+          Utils::setInt(command.substring(comma + 1), envelopeShift, 0, 15) < 0) {
+        return -1;
+      }
+      channels.decimation = decimation;
+      channels.envelopeShift = envelopeShift;
+      channels.resetFilter();
+      return 1;
+    }
+
     void monitor_sensor() {
       getVoltages();
-      button.checkState();
-      if (button.isPressed()) {
-        buttonStateInPublishInterval = HIGH;
-      }
+      checkButton();
       if (Utils::alwaysPublishData) {
-        if (!Utils::getDeviceID().equals("PHOTON_07")) {
-          publish_max(millis() - Utils::startPublishDataMillis);
-          oledWrapper->displayValueAndTime(getZeroCorrected(),
-                                Utils::elapsedTime(millis() - Utils::startPublishDataMillis));
+        if (!isPhoton07()) {
+          publish_max(Clock::millis64() - Utils::startPublishDataMillis);
           if (Utils::publishDataDone()) {
-            oledWrapper->clear();
+            renderScheduler.clear();
           }
         }
       } else if (in_publishing_window()) {
-        // publish_max(millis() - last_millis_of_max);
+        // publish_max(Clock::millis64() - channels.lastMillisOfMax[0]);
         // display();
       }
     }
 
-    void display(String timeStr) {
-      oledWrapper->displayValueAndTime(max_A0, timeStr);
+    // In idle mode loop() waits here until the next burst is due instead of
+    // spinning: delay() runs the system thread and lets the CPU sleep.
+    void waitForNextBurst() {
+      if (activeMode) {
+        return;
+      }
+      uint64_t now = Clock::millis64();
+      uint64_t due = lastBurst + IDLE_PERIOD_MS;
+      if (due > now) {
+        delay(due - now);
+        waitMillis += due - now;
+      }
+    }
+
+    static bool isPhoton07() {
+      static const bool photon07 = Utils::getDeviceID().equals("PHOTON_07");
+      return photon07;
+    }
+
+    bool onDisplay() {
+      return Utils::alwaysPublishData && !isPhoton07();
+    }
+
+    // Partial renderers, registered with the RenderScheduler in App::setup(). The
+    // value and time use the area above the chart.
+    bool render(OLEDWrapper& oled) {
+      if (!onDisplay()) {
+        return false;
+      }
+      uint8_t h = oled.height() - (StripChart::fits(oled) ? StripChart::HEIGHT : 0);
+      oled.clearArea(0, 0, oled.width(), h);
+      oled.drawValueAndTime(getZeroCorrected(), Clock::millis64() - Utils::startPublishDataMillis);
+      oled.flushArea(0, 0, oled.width(), h);
+      return true;
     }
 
-    void display() {
-      display(timeSupport.getUpTime());
+    bool renderChart(OLEDWrapper& oled) {
+      return onDisplay() && chart.render(oled, renderScheduler.generation());
     }
 
     void sample_and_publish_() {
+      lastBurst = 0;    // sample now, also in idle mode
       getVoltages();
-      do_publish(millis() - last_millis_of_max);
+      do_publish(Clock::millis64() - channels.lastMillisOfMax[0]);
     }
     void publishJson() {
       Particle.publish("SensorHandler json", getJson());
@@ -631,8 +2213,35 @@ int sample_and_publish(String cmd) {
   return 1;
 }
 
+int set_samples(String cmd) {
+  return sensorhandler.setSamples(cmd);
+}
+
+int set_channels(String cmd) {
+  return sensorhandler.setChannels(cmd);
+}
+
+int set_channel_params(String cmd) {
+  return sensorhandler.setChannelParams(cmd);
+}
+
+int set_filter(String cmd) {
+  return sensorhandler.setFilter(cmd);
+}
+
+bool render_sensor(OLEDWrapper& oled) {
+  return sensorhandler.render(oled);
+}
+
+bool render_chart(OLEDWrapper& oled) {
+  return sensorhandler.renderChart(oled);
+}
+
 int publish_settings(String cmd);
+#ifdef OLED_SWITCHABLE
 int switch_to_u8g2(String cmd);
+#endif
+bool render_up_time(OLEDWrapper& oled);
 
 class App {
   public:
@@ -645,59 +2254,91 @@ class App {
         } else if (command.compareTo("sensor") == 0) {
             sensorhandler.publishJson();
         } else if (command.compareTo("oled") == 0) {
-            oledWrapper->publishJson();
+            oledWrapper.publishJson();
+        } else if (command.compareTo("render") == 0) {
+            Particle.publish("RenderScheduler json", renderScheduler.getJson());
+        } else if (command.compareTo("heap") == 0) {
+            HeapStats::publishJson();
+        } else if (command.compareTo("offline") == 0) {
+            Particle.publish("OfflineStore json", offlineStore.getJson());
+#ifdef PERF_COUNTERS
+        } else if (command.compareTo("perf") == 0) {
+            Perf::publishJson();
+#endif
+#ifdef TRACE_EVENTS
+        } else if (command.compareTo("trace") == 0) {
+            std::lock_guard<std::mutex> guard(logHandler.serialLock());
+            Trace::dump(Serial);
+#endif
         } else {
             String msg(command);
-            msg.concat(" : expected one of [empty], \"time\", \"sensor\", \"oled\"");
+            msg.concat(" : expected one of [empty], \"time\", \"sensor\", \"oled\", \"render\", \"heap\", \"offline\"");
+#ifdef PERF_COUNTERS
+            msg.concat(", \"perf\"");
+#endif
+#ifdef TRACE_EVENTS
+            msg.concat(", \"trace\"");
+#endif
             Particle.publish("publish_settings bad input", msg);
             return -1;
         }
         return 1;
     }
-    unsigned long lastUpTimeDisplay = 0;
     unsigned int lastY = 0;
-    void displayUpTime() {
-      if (millis() - lastUpTimeDisplay > 1000) {
-        lastY += 1;
-        if (lastY > 32 - 12) {
-          lastY = 0;
-        }
-        oledWrapper->display(timeSupport.getUpTime(), 2, 0, lastY);
-        lastUpTimeDisplay = millis();
+    bool renderUpTime(OLEDWrapper& oled) {
+      lastY += 1;
+      if (lastY > 32 - 12) {
+        lastY = 0;
       }
+      char upTime[TimeSupport::MIN_SEC_SIZE];
+      oled.draw(timeSupport.getUpTime(upTime, sizeof(upTime)), 2, 0, lastY);
+      return true;
     }
+#ifdef OLED_SWITCHABLE
     int switch_to_u8g2_(String cmd) {
-      if (oledWrapper != nullptr) {
-        delete oledWrapper;
-      }
-      oledWrapper = new OLEDWrapperU8g2();
-      oledWrapper->startup();
-/*      oledWrapper->display("Using U8g2", 1);
+      oledWrapper.select(u8g2Driver);
+      oledWrapper.startup();
+      renderScheduler.clear();    // the partial renderers redraw everything
+/*      oledWrapper.display("Using U8g2", 1);
       delay(2000);
-      oledWrapper->clear();
+      oledWrapper.clear();
 */      return 1;
     } 
+#endif
     void setup() {
-      oledWrapper = new OLEDWrapper();
-      oledWrapper->startup();
-      oledWrapper->display("Starting setup...", 1);
+      oledWrapper.startup();
+      renderScheduler.show(nullptr, 0, 1000);   // the splash screen
+      renderScheduler.show("Starting setup...", 1, 0);
+      renderScheduler.tick();
+      renderScheduler.addPartial(render_sensor, 1000, 1);
+      renderScheduler.addPartial(render_chart, 0, 2);
+      renderScheduler.add(render_up_time, 1000, 0, false);    // not shown by default
       Particle.function("GetData", sample_and_publish);
       Particle.function("GetSetting", publish_settings);
       Particle.function("reset", remoteResetFunction);
       Particle.function("alwaysPub", setAlwaysPublishData);
+#ifdef OLED_SWITCHABLE
       Particle.function("switchOled", switch_to_u8g2);
-      delay(1000);
+#endif
+      Particle.function("samples", set_samples);
+      Particle.function("channels", set_channels);
+      Particle.function("chanParams", set_channel_params);
+      Particle.function("filter", set_filter);
       button.begin();
+      offlineStore.begin();
       Utils::publishJson();
+      renderScheduler.tick();
       sensorhandler.sample_and_publish_();
-      oledWrapper->display("Setup finished", 1);
-      delay(2000);
-      oledWrapper->clear();
+      renderScheduler.show("Setup finished", 1, 2000);
+      renderScheduler.tick();
       Utils::publish("setup()", "Finished");
     }
     void loop() {
+      PERF_SCOPE(loop);
       timeSupport.handleTime();
       sensorhandler.monitor_sensor();
+      renderScheduler.tick();
+      offlineStore.replay();
       Utils::checkForRemoteReset();
     }
 };
@@ -707,9 +2348,15 @@ int publish_settings(String cmd) {
   return app.publish_settings_(cmd);
 }
 
+#ifdef OLED_SWITCHABLE
 int switch_to_u8g2(String cmd) {
   return app.switch_to_u8g2_(cmd);
 }
+#endif
+
+bool render_up_time(OLEDWrapper& oled) {
+  return app.renderUpTime(oled);
+}
 
 void setup() {
   app.setup();
@@ -717,4 +2364,5 @@ void setup() {
 
 void loop() {
   app.loop();
+  sensorhandler.waitForNextBurst();   // not part of the "loop" perf section
 }
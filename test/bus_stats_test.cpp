@@ -0,0 +1,120 @@
+/*
+
+  bus_stats_test.cpp
+
+  Checks the bus statistics of U8g2 (u8x8_bus_stats.c) and of the MicroOLED
+  library and prints the per frame breakdown of the displays of the
+  firmware:
+    SSD1327 128x128 over I2C, full frame with u8g2_SendBuffer()
+    SSD1306 64x48 over SPI, two u8g2 displays at the same time
+    MicroOLED over I2C and SPI, MicroOLED::display()
+
+  The MicroOLED counts are compared with the bytes, which the Wire and SPI
+  mocks (test/mock) actually received.
+
+*/
+
+#include "u8g2.h"
+#include "SparkFunMicroOLED.h"
+
+static int fails;
+
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while( 0 )
+
+static void report(const char *name, uint32_t transfers, uint32_t cmd_bytes, uint32_t data_bytes, uint32_t us)
+{
+  printf("%-24s %9lu %9lu %9lu %9.2f\n", name, (unsigned long)transfers, (unsigned long)cmd_bytes,
+    (unsigned long)data_bytes, us / 1000.0);
+}
+
+static void test_u8g2(void)
+{
+  u8g2_t ssd1327, ssd1306;
+  u8x8_bus_stats_t stats1327, stats1306;
+
+  u8g2_Setup_ssd1327_i2c_ea_w128128_f(&ssd1327, U8G2_R0, u8x8_byte_empty, u8x8_dummy_cb);
+  u8g2_Setup_ssd1306_64x48_er_f(&ssd1306, U8G2_R0, u8x8_byte_empty, u8x8_dummy_cb);
+  u8g2_GetU8x8(&ssd1327)->bus_clock = 400000;	/* u8g2.setBusClock(400000) of the firmware */
+  u8x8_InstallBusStats(u8g2_GetU8x8(&ssd1327), &stats1327, 1);
+  u8x8_InstallBusStats(u8g2_GetU8x8(&ssd1306), &stats1306, 0);
+  u8g2_InitDisplay(&ssd1327);
+  u8g2_InitDisplay(&ssd1306);
+  CHECK(stats1327.cmd_bytes > 0 && stats1306.cmd_bytes > 0);
+
+  /* each display counts only its own transfers */
+  u8x8_ClearBusStats(u8g2_GetU8x8(&ssd1327));
+  u8x8_ClearBusStats(u8g2_GetU8x8(&ssd1306));
+  u8g2_SendBuffer(&ssd1327);
+  CHECK(stats1327.data_bytes == 128 * 128 / 2);
+  CHECK(stats1306.transfers == 0 && stats1306.clocks == 0);
+  report("ssd1327_i2c_128x128", stats1327.transfers, stats1327.cmd_bytes, stats1327.data_bytes,
+    u8x8_GetBusStatsMicros(u8g2_GetU8x8(&ssd1327)));
+
+  u8x8_ClearBusStats(u8g2_GetU8x8(&ssd1327));
+  u8g2_SendBuffer(&ssd1306);
+  CHECK(stats1306.data_bytes == 64 * 48 / 8);
+  CHECK(stats1306.clocks == 8 * (stats1306.cmd_bytes + stats1306.data_bytes));
+  CHECK(stats1327.transfers == 0 && stats1327.clocks == 0);
+  report("ssd1306_spi_64x48", stats1306.transfers, stats1306.cmd_bytes, stats1306.data_bytes,
+    u8x8_GetBusStatsMicros(u8g2_GetU8x8(&ssd1306)));
+
+  /* installing again keeps the original byte procedure */
+  u8x8_InstallBusStats(u8g2_GetU8x8(&ssd1327), &stats1327, 1);
+  CHECK(stats1327.byte_cb == u8x8_byte_empty);
+}
+
+static uint32_t wire_transfers, wire_cmd_bytes, wire_data_bytes;
+static uint32_t spi_bytes;
+
+static void test_micro_oled(micro_oled_mode mode, const char *name)
+{
+  MicroOLED oled(mode);
+  micro_oled_bus_stats stats;
+
+  wire_transfers = wire_cmd_bytes = wire_data_bytes = spi_bytes = 0;
+  mock::i2cHook = [](uint8_t, const uint8_t *data, size_t n) {
+    wire_transfers++;
+    if ( n > 0 && data[0] == I2C_DATA )
+      wire_data_bytes += n - 1;
+    else if ( n > 0 )
+      wire_cmd_bytes += n - 1;
+  };
+  mock::spiHook = [](uint8_t) { spi_bytes++; };
+
+  oled.begin();
+  CHECK(oled.getBusStatsMicros() == 0);
+  oled.setBusStats(&stats);
+  wire_transfers = wire_cmd_bytes = wire_data_bytes = spi_bytes = 0;
+  oled.display();
+  CHECK(stats.dataBytes == LCDWIDTH * LCDHEIGHT / 8);
+  if ( mode == MODE_I2C )
+  {
+    CHECK(stats.transfers == wire_transfers);
+    CHECK(stats.cmdBytes == wire_cmd_bytes);
+    CHECK(stats.dataBytes == wire_data_bytes);
+    CHECK(stats.clocks == 29 * wire_transfers);
+  }
+  else
+  {
+    CHECK(stats.transfers == spi_bytes);
+    CHECK(stats.cmdBytes + stats.dataBytes == spi_bytes);
+    CHECK(stats.clocks == 8 * spi_bytes);
+  }
+  report(name, stats.transfers, stats.cmdBytes, stats.dataBytes, oled.getBusStatsMicros());
+
+  oled.setBusStats(NULL);
+  oled.display();
+  CHECK(oled.getBusStatsMicros() == 0);
+  mock::i2cHook = nullptr;
+  mock::spiHook = nullptr;
+}
+
+int main(void)
+{
+  printf("%-24s %9s %9s %9s %9s\n", "frame", "transfers", "cmd", "data", "ms");
+  test_u8g2();
+  test_micro_oled(MODE_I2C, "microoled_i2c_64x48");
+  test_micro_oled(MODE_SPI, "microoled_spi_64x48");
+  printf(fails ? "%d FAILED\n" : "all passed\n", fails);
+  return fails != 0;
+}
@@ -0,0 +1,167 @@
+// The button interrupt tags each edge with the sample block and the publish
+// interval it happened in. Presses are fired from analogRead() (during a burst)
+// and from delay() (between bursts) of setup() and loop(), and checked against
+// the counters when their first edge was fired, also when the press is debounced
+// several blocks later or after the interval was published. A bouncing press
+// keeps its first edge, and a glitch before a press is neither a press nor its
+// first edge.
+#include <deque>
+#include <string>
+#include "firmware.h"
+
+static const uint64_t MS = 1000;
+static const uint64_t ADC_READ_MICROS = 10;
+
+struct ScriptedEdge {
+  uint64_t at;
+  int      level;
+  bool     first;       // the first edge of the press
+};
+
+static int      pinLevel = LOW;
+static std::deque<ScriptedEdge> script;   // in time order
+static bool     pressFired = false;
+static uint64_t pressedAt = 0;            // micros() of the first edge of the press
+static bool     pressedInRead = false;
+
+// Counters of the firmware before the current loop.
+static uint32_t blocksBefore, intervalsBefore;
+
+static uint32_t setting(const char* name) {
+  sensorhandler.publishJson();
+  const std::string& json = mock::publishes.back().data;
+  size_t pos = json.find(std::string("\"") + name + "\":\"");
+  CHECK(pos != std::string::npos);
+  return pos == std::string::npos ? 0 : strtoul(json.c_str() + pos + strlen(name) + 4, nullptr, 10);
+}
+
+static bool inBlockSetting() {
+  sensorhandler.publishJson();
+  return mock::publishes.back().data.find("\"last_press_in_block\":\"true\"") != std::string::npos;
+}
+
+static void fireEdges(bool inRead) {
+  while (!script.empty() && mock::nowMicros >= script.front().at) {
+    if (script.front().first) {
+      pressFired = true;
+      pressedAt = mock::nowMicros;
+      pressedInRead = inRead;
+    }
+    pinLevel = script.front().level;
+    script.pop_front();
+    mock::interruptHandler(D2)();
+  }
+}
+
+// A change to `level` at `at`, which bounces `bounces` times every `bounceUs`.
+static void addChange(uint64_t at, int level, int bounces, uint64_t bounceUs, bool first) {
+  script.push_back({ at, level, first });
+  for (int i = 1; i <= 2 * bounces; i++) {
+    script.push_back({ at + i * bounceUs, i % 2 ? !level : level, false });
+  }
+}
+
+static void loopUntil(uint64_t us) {
+  while (mock::nowMicros < us) {
+    blocksBefore = setting("blocks");
+    intervalsBefore = setting("publishIntervals");
+    firmwareLoop();
+  }
+}
+
+// Presses at `at` for `holdMs`, returns after it is debounced. The expected
+// block and interval are those of the loop the first edge was fired in.
+static void press(uint64_t at, uint64_t holdMs, int bounces, uint32_t* block, bool* inBlock, uint32_t* interval) {
+  uint32_t presses = button.getPresses();
+  uint64_t releaseAt = at + holdMs * MS;
+  addChange(at, HIGH, bounces, 3 * MS, true);
+  addChange(releaseAt, LOW, bounces, 3 * MS, false);
+  pressFired = false;
+  *block = 0;
+  while (button.getPresses() == presses) {
+    blocksBefore = setting("blocks");
+    intervalsBefore = setting("publishIntervals");
+    firmwareLoop();
+    if (pressFired && *block == 0) {
+      // fired in this loop: in its burst, or after it (delay() of the loop)
+      *inBlock = pressedInRead;
+      *block = pressedInRead ? blocksBefore + 1 : setting("blocks");
+      *interval = intervalsBefore;
+    }
+  }
+  CHECK(button.getPresses() == presses + 1);
+  loopUntil(releaseAt + 100 * MS);
+  CHECK(script.empty());
+}
+
+static void checkPress(const char* name, uint32_t block, bool inBlock, uint32_t interval) {
+  uint32_t blocks = setting("blocks");
+  printf("%-40s block %u (%s), %u blocks later, interval %u\n", name, (unsigned)block,
+         inBlock ? "in burst" : "between bursts", (unsigned)(blocks - block), (unsigned)interval);
+  CHECK(button.lastPress() == (uint32_t)pressedAt);
+  CHECK(setting("last_press_block") == block);
+  CHECK(inBlockSetting() == inBlock);
+  CHECK(setting("last_press_interval") == interval);
+}
+
+int main() {
+  mock::digitalReadHook = [](pin_t pin) { return pin == D2 ? pinLevel : HIGH; };
+  mock::analogReadHook = [](pin_t) {
+    mock::nowMicros += ADC_READ_MICROS;
+    fireEdges(true);
+    return (int32_t)(Utils::getDeviceBaseline() + Utils::getDeviceZeroCorrection());
+  };
+  mock::onAdvance = [](uint64_t) { fireEdges(false); };
+  mock::nowMicros = 0;
+  firmwareSetup();
+  Utils::setAlwaysPublishData();
+  uint32_t block, interval;
+  bool inBlock;
+
+  // active mode after boot: back to back bursts of 10 ms, the press is
+  // debounced (50 ms) several blocks after the one it started in
+  loopUntil(2000 * MS);
+  press(mock::nowMicros + 3 * MS, 200, 0, &block, &inBlock, &interval);
+  CHECK(pressedInRead);
+  CHECK(setting("blocks") - block >= 3);
+  checkPress("active mode, in a burst", block, inBlock, interval);
+
+  // the press bounces for 30 ms, over three blocks: it belongs to the block
+  // of its first edge, not of the last bounce
+  press(mock::nowMicros + 3 * MS, 200, 5, &block, &inBlock, &interval);
+  CHECK(pressedInRead);
+  CHECK(setting("blocks") - block >= 6);
+  checkPress("active mode, bouncing", block, inBlock, interval);
+
+  // idle mode: short bursts every 50 ms, the loop waits in delay() between them
+  loopUntil(70000 * MS);
+  CHECK(setting("idleSamples") > 0);
+  press(mock::nowMicros + 20 * MS, 200, 0, &block, &inBlock, &interval);
+  CHECK(!pressedInRead);
+  checkPress("idle mode, between bursts", block, inBlock, interval);
+
+  // a glitch of 10 ms, the press follows 100 ms later
+  uint32_t presses = button.getPresses();
+  addChange(mock::nowMicros + 20 * MS, HIGH, 0, 0, false);
+  addChange(mock::nowMicros + 30 * MS, LOW, 0, 0, false);
+  press(mock::nowMicros + 130 * MS, 200, 2, &block, &inBlock, &interval);
+  CHECK(button.getPresses() == presses + 1);
+  checkPress("idle mode, after a glitch", block, inBlock, interval);
+
+  // a press started just before the interval is published: it is counted in
+  // the next interval, but belongs to the one it started in
+  uint32_t intervals = setting("publishIntervals");
+  loopUntil(mock::nowMicros + 100 * MS);
+  while (setting("publishIntervals") == intervals) {
+    firmwareLoop();
+  }
+  uint64_t published = mock::nowMicros;
+  press(published + 4990 * MS, 200, 0, &block, &inBlock, &interval);
+  CHECK(setting("publishIntervals") > interval);
+  checkPress("started before the publish", block, inBlock, interval);
+
+  mock::onAdvance = nullptr;
+  mock::analogReadHook = nullptr;
+  mock::digitalReadHook = nullptr;
+  return testResult();
+}
@@ -0,0 +1,74 @@
+// Per channel parameters: the "chanParams" function sets the baseline, zero
+// correction and max of the channels 1..3, which the settings report and the
+// "vibration" event applies, and rejects channel 0 and malformed commands.
+#include "firmware.h"
+
+static const uint16_t BASELINE_1 = 100;
+static const uint16_t ZERO_CORRECTION_1 = 200;
+static const uint16_t MAX_1 = 300;
+
+static std::string lastData(const char* name) {
+  for (auto it = mock::publishes.rbegin(); it != mock::publishes.rend(); ++it) {
+    if (it->name == name) {
+      return it->data;
+    }
+  }
+  return "";
+}
+
+static bool has(const std::string& data, const std::string& setting) {
+  return data.find(setting) != std::string::npos;
+}
+
+static std::string settings() {
+  sensorhandler.publishJson();
+  return lastData("SensorHandler json");
+}
+
+// publishes the max of the next burst, with the level of channel 1
+static std::string publishWith(int32_t level1) {
+  mock::analogReadHook = [level1](pin_t pin) -> int32_t {
+    return pin == A1 ? level1 : UNKNOWN_DEVICE.baseline;
+  };
+  mock::nowMicros += 10 * 1000000;
+  sensorhandler.monitor_sensor();
+  return lastData("vibration");
+}
+
+int main() {
+  // before the channel is turned on, channel 1 can be configured
+  CHECK(set_channel_params("1,100,200,300") == 1);
+  CHECK(set_channels("2") == 1);
+  std::string json = settings();
+  CHECK(has(json, "\"numChannels\":\"2\""));
+  CHECK(has(json, "\"baseline_1\":\"100\""));
+  CHECK(has(json, "\"zeroCorrection_1\":\"200\""));
+  CHECK(has(json, "\"maxValue_1\":\"300\""));
+
+  // channel 0, out of range and malformed commands leave the parameters
+  for (const char* bad : { "0,1,2,3", "4,1,2,3", "1,100,200", "1,100,200,300,400",
+                           "1,100,200,5000", "1,-1,200,300", "" }) {
+    CHECK(set_channel_params(bad) == -1);
+  }
+  CHECK(settings() == json);
+
+  // channel 1 subtracts its own baseline and zero correction ...
+  Utils::setAlwaysPublishData();
+  int32_t level = BASELINE_1 + ZERO_CORRECTION_1 + 50;
+  CHECK(has(publishWith(level), "\"max_in_publish_interval_1\":\"50\""));
+  // ... and is clamped at its own max, channel 0 would allow 575
+  level = BASELINE_1 + 1000;
+  CHECK(has(publishWith(level), "\"max_in_publish_interval_1\":\"" + std::to_string(MAX_1 - ZERO_CORRECTION_1) + "\""));
+  CHECK(has(lastData("vibration"), "\"max_in_publish_interval\":\"0\""));
+
+  // a channel added later starts with the parameters of channel 0
+  CHECK(set_channels("3") == 1);
+  json = settings();
+  CHECK(has(json, "\"baseline_2\":\"" + std::to_string(UNKNOWN_DEVICE.baseline) + "\""));
+  CHECK(has(json, "\"zeroCorrection_2\":\"" + std::to_string(UNKNOWN_DEVICE.zeroCorrection) + "\""));
+  CHECK(has(json, "\"maxValue_2\":\"" + std::to_string(UNKNOWN_DEVICE.maxValue) + "\""));
+  CHECK(has(json, "\"baseline_1\":\"100\""));
+
+  mock::analogReadHook = nullptr;
+  return testResult();
+}
@@ -0,0 +1,41 @@
+// Clock::millis64() and micros64() across the wrap of the 32 bit counters
+// millis() and micros() of the mock, also with calls more than one wrap apart.
+#include "firmware.h"
+
+static const uint64_t MICROS_WRAP = 1ULL << 32;            // micros() wraps after ~71.6 minutes
+static const uint64_t MILLIS_WRAP = (1ULL << 32) * 1000;   // millis() after ~49.7 days
+
+static void checkAt(uint64_t us) {
+  mock::nowMicros = us;
+  CHECK(Clock::micros64() == us);
+  CHECK(Clock::millis64() == us / 1000);
+}
+
+int main() {
+  // across 0xFFFFFFFF of micros(), in small steps
+  for (uint64_t us = MICROS_WRAP - 2500; us < MICROS_WRAP + 2500; us += 7) {
+    checkAt(us);
+  }
+  CHECK((uint32_t)micros() < 2500);
+
+  // calls one wrap and more apart: the second sees the same 32 bit values
+  checkAt(MICROS_WRAP - 10);
+  checkAt(2 * MICROS_WRAP - 10);
+  checkAt(5 * MICROS_WRAP + 123456);
+
+  // a difference over a long gap
+  mock::nowMicros = 3 * MICROS_WRAP + 1000;
+  uint64_t start = Clock::micros64();
+  unsigned long gapMillis = 3 * MICROS_WRAP / 1000 + 17;
+  delay(gapMillis);
+  CHECK(Clock::micros64() - start == gapMillis * 1000ULL);
+
+  // across 0xFFFFFFFF of millis()
+  for (uint64_t us = MILLIS_WRAP - 5000000; us < MILLIS_WRAP + 5000000; us += 999983) {
+    checkAt(us);
+  }
+  CHECK(millis() < 5000);
+  checkAt(MILLIS_WRAP - 1000);
+  checkAt(3 * MILLIS_WRAP + 1000);
+  return testResult();
+}
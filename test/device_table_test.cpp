@@ -0,0 +1,54 @@
+// The device table (DEVICES): the Utils getters and the sensor pipeline of
+// createSensorPipeline() agree for every device and for an unknown one, and
+// the pipeline is compiled for the device exactly when fixedProfile is set.
+// The chart of an unknown device (no sensor) still has a range.
+#include "firmware.h"
+
+template <int I = 0>
+static bool isFixedPipeline(SensorPipelineBase* pipeline, int device) {
+  if constexpr (I < NUM_DEVICES) {
+    if (device == I) {
+      return dynamic_cast<SensorPipeline<DeviceProfile<I>>*>(pipeline) != nullptr;
+    }
+    return isFixedPipeline<I + 1>(pipeline, device);
+  } else {
+    return false;
+  }
+}
+
+static void checkDevice(const char* id, const DeviceParams& expected, int index) {
+  mock::deviceID = id;
+  CHECK(Utils::getDeviceIndex() == index);
+  CHECK(Utils::getDeviceBaseline() == expected.baseline);
+  CHECK(Utils::getDeviceZeroCorrection() == expected.zeroCorrection);
+  CHECK(Utils::getMaxVibrationValue() == expected.maxValue);
+  SensorPipelineBase* pipeline = createSensorPipeline();
+  CHECK(pipeline->baseline() == expected.baseline);
+  CHECK(pipeline->zeroCorrection() == expected.zeroCorrection);
+  CHECK(pipeline->maxValue() == expected.maxValue);
+  bool runtime = dynamic_cast<SensorPipeline<RuntimeProfile>*>(pipeline) != nullptr;
+  CHECK(runtime == !expected.fixedProfile);
+  CHECK(isFixedPipeline(pipeline, index) == expected.fixedProfile);
+}
+
+int main() {
+  for (int i = 0; i < NUM_DEVICES; i++) {
+    checkDevice(DEVICES[i].id, DEVICES[i], i);
+    CHECK(Utils::getDeviceID().equals(DEVICES[i].name));
+    CHECK(Utils::getDeviceLocation().equals(DEVICES[i].location));
+  }
+  checkDevice("000000000000000000000000", UNKNOWN_DEVICE, -1);
+  CHECK(Utils::getDeviceID().startsWith("Unknown deviceID: "));
+  // the zero correction is at the max value
+  CHECK(UNKNOWN_DEVICE.maxValue == UNKNOWN_DEVICE.zeroCorrection);
+  CHECK(sensorhandler.chartRange() == MAX_VIBRATION_VALUE);
+
+  // the values the getters had before the table
+  mock::deviceID = PHOTON_01;
+  CHECK(Utils::getDeviceLocation().equals("Dryer"));
+  CHECK(Utils::getMaxVibrationValue() == MAX_VIBRATION_VALUE + 100);
+  CHECK(Utils::getDeviceZeroCorrection() == 555);
+  mock::deviceID = PHOTON_07;
+  CHECK(Utils::getDeviceBaseline() == 100 && Utils::getDeviceZeroCorrection() == 415);
+  return testResult();
+}
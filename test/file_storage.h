@@ -0,0 +1,52 @@
+// File-backed storage for OfflineStore on the host, same interface as
+// EEPROMStorage. Every put() goes to the file at once (pwrite), like the
+// EEPROM write on the device. powerCutAfter() simulates a power cut: the
+// storage writes that many more bytes, one at a time, and drops the rest.
+#pragma once
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+template <int Size>
+class FileStorage {
+  private:
+    struct File {
+      int fd;
+      long budget = -1;     // bytes left before the power cut, -1: no cut
+      File(const char* path) : fd(open(path, O_RDWR | O_CREAT, 0644)) {}
+      ~File() { close(fd); }
+    };
+    std::shared_ptr<File> file;   // OfflineStore copies its storage
+  public:
+    static const int SIZE = Size;
+
+    explicit FileStorage(const char* path) : file(std::make_shared<File>(path)) {}
+
+    bool isOpen() const {
+      return file->fd >= 0;
+    }
+    // A new file reads as erased EEPROM (0xFF).
+    void erase() {
+      uint8_t erased[SIZE];
+      memset(erased, 0xFF, SIZE);
+      pwrite(file->fd, erased, SIZE, 0);
+    }
+    void powerCutAfter(long bytes) {
+      file->budget = bytes;
+    }
+    template <class T> void get(int address, T& t) {
+      pread(file->fd, &t, sizeof(T), address);
+    }
+    template <class T> void put(int address, const T& t) {
+      if (file->budget < 0) {
+        pwrite(file->fd, &t, sizeof(T), address);
+        return;
+      }
+      const uint8_t* p = (const uint8_t*)&t;
+      for (size_t i = 0; i < sizeof(T) && file->budget > 0; i++, file->budget--) {
+        pwrite(file->fd, p + i, 1, address + i);
+      }
+    }
+};
@@ -0,0 +1,215 @@
+// SensorChannels::filterBurst() against a floating point model of the same
+// filter: sine sweeps through the CIC decimator and the envelope follower
+// (frequency response, and equal to the model within a count), and full
+// scale steps at the largest decimation and release (no overflow).
+#include <cmath>
+#include <vector>
+#include "firmware.h"   // after the standard headers, SparkFunMicroOLED.h defines swap()
+
+static const int FULL_SCALE = 4095;   // 12 bit ADC
+static const double MID = 2048;
+static const double MAX_ERROR = 2;   // counts, the fixed point truncates
+
+// The filter of filterBurst() in double, one channel.
+struct FloatFilter {
+  int    decimation;
+  int    envelopeShift;
+  double acc = 0;
+  int    n = 0;
+  double dc = 0;
+  int    dcCount = 0;
+  double env = 0;
+  double max = 0;
+
+  void add(int reading) {
+    acc += reading;
+    if (++n < decimation) {
+      return;
+    }
+    double x = acc / decimation;
+    double y = x;
+    n = 0;
+    acc = 0;
+    if (envelopeShift > 0) {
+      if (dcCount < 4096) {    // 1 << DC_SHIFT
+        dc += (x - dc) / ++dcCount;
+      } else {
+        dc += (x - dc) / 4096;
+      }
+      double a = std::fabs(x - dc);
+      if (a > env) {
+        env += (a - env) / 4;  // ATTACK_SHIFT
+      } else {
+        env -= env / (1 << envelopeShift);
+      }
+      y = dc + env;
+    }
+    max = std::max(max, y);
+  }
+};
+
+// Readings of channel 0, and of channel 1 if signal1 is set.
+static std::vector<int> signal0, signal1;
+static size_t next0, next1;
+
+static void useSignal(SensorChannels& ch, int count) {
+  next0 = next1 = 0;
+  ch.count = count;
+  mock::analogReadHook = [](pin_t pin) {
+    if (pin == A1) {
+      return signal1[next1++ % signal1.size()];
+    }
+    return signal0[next0++ % signal0.size()];
+  };
+}
+
+static std::vector<int> sine(double cyclesPerReading, double amplitude, int n) {
+  std::vector<int> v(n);
+  for (int i = 0; i < n; i++) {
+    v[i] = (int)std::lround(MID + amplitude * std::sin(2 * M_PI * cyclesPerReading * i));
+  }
+  return v;
+}
+
+// Runs `bursts` bursts on the fixed point filter and the model, returns the
+// largest difference of the burst maxima in counts, the response is the
+// envelope (max minus MID) of the last burst relative to amplitude.
+static double compare(SensorChannels& ch, int bursts, int numSamples, double amplitude, double* response) {
+  FloatFilter model { ch.decimation, ch.envelopeShift };
+  model.dc = ch.dc[0] / 65536.0;
+  model.dcCount = ch.dcCount[0];
+  size_t reading = 0;
+  double maxError = 0;
+  for (int b = 0; b < bursts; b++) {
+    ch.filterBurst(numSamples);
+    model.max = 0;
+    model.acc = 0;
+    model.n = 0;
+    for (int i = 0; i < numSamples; i++) {
+      model.add(signal0[reading++ % signal0.size()]);
+    }
+    maxError = std::max(maxError, std::fabs(ch.rawMax[0] - model.max));
+  }
+  *response = (ch.rawMax[0] - MID) / amplitude;
+  return maxError;
+}
+
+// Gain of the mean of d readings at f cycles per reading.
+static double cicGain(double f, int d) {
+  return std::fabs(std::sin(M_PI * f * d) / (d * std::sin(M_PI * f)));
+}
+
+static void testSweep(int decimation, int envelopeShift) {
+  const double AMPLITUDE = 1500;
+  const int NUM_SAMPLES = 256 * decimation;
+  printf("decimation %d, envelope release shift %d\n", decimation, envelopeShift);
+  printf("  %12s %8s %8s %8s\n", "cycles/dec", "CIC", "filter", "error");
+  for (double fd = 0.0173; fd < 1.5; fd *= 1.37) {
+    double f = fd / decimation;
+    SensorChannels ch;
+    ch.decimation = decimation;
+    ch.envelopeShift = envelopeShift;
+    ch.dc[0] = (int32_t)MID << 16;   // settled, see testSettling()
+    ch.dcCount[0] = 1 << 12;
+    signal0 = sine(f, AMPLITUDE, 1 << 20);
+    useSignal(ch, 1);
+    double response;
+    double error = compare(ch, 8, NUM_SAMPLES, AMPLITUDE, &response);
+    double gain = decimation > 1 ? cicGain(f, decimation) : 1;
+    printf("  %12.4f %8.3f %8.3f %8.1f\n", fd, gain, response, error);
+    CHECK(error <= MAX_ERROR);
+    // at most the decimated sine, within the quantization
+    CHECK(response <= gain + 2 / AMPLITUDE);
+    if (envelopeShift == 0) {
+      CHECK(response >= gain - 0.02);
+    } else if (fd < 0.03) {
+      CHECK(response > 0.9);
+    }
+  }
+  // a sine with whole cycles in each decimation window is removed
+  if (decimation > 1) {
+    SensorChannels ch;
+    ch.decimation = decimation;
+    ch.envelopeShift = envelopeShift;
+    signal0 = sine(1.0 / decimation, AMPLITUDE, decimation * 1000);
+    useSignal(ch, 1);
+    double response;
+    CHECK(compare(ch, 4, NUM_SAMPLES, AMPLITUDE, &response) <= MAX_ERROR);
+    CHECK(std::fabs(response) < 2 / AMPLITUDE);
+  }
+}
+
+// From resetFilter(): the DC tracker starts at the first sample, here the
+// crest of the sine. While it settles, the envelope reads its offset on top
+// of the amplitude; the running mean keeps that small from the first burst.
+static void testSettling(int decimation, int envelopeShift) {
+  const double AMPLITUDE = 1500;
+  printf("settling, decimation %d, envelope release shift %d\n", decimation, envelopeShift);
+  printf("  %12s %8s %8s\n", "cycles/dec", "CIC", "filter");
+  for (double fd = 0.0173; fd < 1.5; fd *= 1.37) {
+    double f = fd / decimation;
+    SensorChannels ch;
+    ch.decimation = decimation;
+    ch.envelopeShift = envelopeShift;
+    std::vector<int> s = sine(f, AMPLITUDE, (1 << 20) + decimation);
+    signal0.assign(s.begin() + (int)(0.25 / f), s.end());   // starts at the crest
+    useSignal(ch, 1);
+    double response;
+    CHECK(compare(ch, 1, 256 * decimation, AMPLITUDE, &response) <= MAX_ERROR);
+    double gain = cicGain(f, decimation);
+    printf("  %12.4f %8.3f %8.3f\n", fd, gain, response);
+    CHECK(response <= gain + 0.15);
+  }
+}
+
+// Two interleaved channels: channel 1 does not disturb channel 0.
+static void testChannels() {
+  SensorChannels ch;
+  ch.decimation = 8;
+  ch.envelopeShift = 6;
+  signal0 = sine(0.003, 900, 1 << 16);
+  signal1 = std::vector<int>(1, FULL_SCALE);
+  useSignal(ch, 2);
+  double response;
+  CHECK(compare(ch, 4, 4096, 900, &response) <= MAX_ERROR);
+  CHECK(ch.rawMax[1] == FULL_SCALE);
+}
+
+// Full scale steps, 0 and FULL_SCALE for `period` readings each, at the
+// largest settings of the "filter" command: the output stays in range and
+// equal to the model, no wrap of the Q16 values.
+static void testSteps(int decimation, int envelopeShift, int period) {
+  SensorChannels ch;
+  ch.decimation = decimation;
+  ch.envelopeShift = envelopeShift;
+  signal0.assign(2 * period, 0);
+  for (int i = 0; i < period; i++) {
+    signal0[i] = FULL_SCALE;
+  }
+  useSignal(ch, 1);
+  double response;
+  CHECK(compare(ch, 16, 64 * 64, FULL_SCALE, &response) <= MAX_ERROR);
+  // DC level plus envelope: at most twice full scale
+  CHECK(ch.rawMax[0] >= FULL_SCALE / 2 && ch.rawMax[0] <= 2 * FULL_SCALE);
+  CHECK(ch.dc[0] >= 0 && ch.dc[0] <= (FULL_SCALE << 16));
+  CHECK(ch.env[0] >= 0 && ch.env[0] <= (FULL_SCALE << 16));
+}
+
+int main() {
+  testSweep(1, 0);
+  testSweep(8, 0);
+  testSweep(64, 0);
+  testSweep(1, 4);
+  testSweep(8, 6);
+  testSweep(64, 15);
+  testSettling(8, 6);
+  testSettling(64, 15);
+  testChannels();
+  for (int period : { 1, 63, 64, 1000 }) {
+    testSteps(64, 15, period);
+    testSteps(64, 1, period);
+    testSteps(1, 15, period);
+  }
+  mock::analogReadHook = nullptr;
+  return testResult();
+}
@@ -0,0 +1,25 @@
+// Includes the firmware (src/vibration-sensor.cpp) into a host test, on top
+// of the Particle mock in test/mock. setup() and loop() of the firmware are
+// renamed to firmwareSetup() and firmwareLoop(), the test has its own main().
+// A test includes this header once, the firmware is part of its translation
+// unit, so the tests can reach the firmware classes directly.
+#pragma once
+#include "Particle.h"
+#include <SparkFunMicroOLED.h>
+#include <U8g2lib.h>
+#define setup firmwareSetup
+#define loop firmwareLoop
+#include "../src/vibration-sensor.cpp"
+#undef setup
+#undef loop
+
+#include <stdio.h>
+
+static int fails;
+
+#define CHECK(c) do { if (!(c)) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while (0)
+
+static int testResult() {
+  printf(fails ? "%d FAILED\n" : "all passed\n", fails);
+  return fails != 0;
+}
@@ -0,0 +1,93 @@
+// The firmware built for the SSD1327 in gray mode (OLED_SSD1327, OLED_GRAY4)
+// against a mono SSD1327 u8g2 object drawing the same text: both sends are
+// decoded into an emulated SSD1327 display RAM. Every pixel lit by the mono
+// send has level 15 in the gray RAM, every other pixel is dark unless it is
+// next to a lit one, where smoothGray4() left an edge level.
+#include <algorithm>
+#include "firmware.h"   // after the standard headers, SparkFunMicroOLED.h defines swap()
+#include "ssd1327_ram.h"
+
+static SSD1327Ram* capture;
+
+static void captureSends() {
+  mock::i2cHook = [](uint8_t, const uint8_t* p, size_t n) {
+    if (capture != nullptr) {
+      capture->transfer(p, n);
+    }
+  };
+}
+
+U8G2_SSD1327_EA_W128128_F_HW_I2C mono(U8G2_R0, U8X8_PIN_NONE);
+
+// Same drawing as U8g2Driver, in the mono buffer.
+static void sendMono(SSD1327Ram& ram, const char* s, const uint8_t* font, int x, int y) {
+  mono.clearBuffer();
+  mono.setFont(font);
+  mono.setFontRefHeightExtendedText();
+  mono.setFontPosTop();
+  mono.setDrawColor(1);
+  mono.setFontDirection(0);
+  mono.drawUTF8(x, y, s);
+  capture = &ram;
+  mono.sendBuffer();
+  capture = nullptr;
+}
+
+static void sendGray(SSD1327Ram& ram, const char* s, int font, int x, int y) {
+  capture = &ram;
+  oledWrapper.display(s, font, x, y);
+  capture = nullptr;
+}
+
+static void compare(const char* s, int font, int x, int y, const u8g2_cb_t* rotation) {
+  SSD1327Ram monoRam, grayRam;
+  mono.setDisplayRotation(rotation);
+  u8g2.setDisplayRotation(rotation);
+  sendMono(monoRam, s, font >= 2 ? u8g2_font_fur49_tn : u8g2_font_ncenB14_tr, x, y);
+  sendGray(grayRam, s, font, x, y);
+
+  int lit = 0, edges = 0, wrong = 0;
+  for (int py = 0; py < 128; py++) {
+    for (int px = 0; px < 128; px++) {
+      uint8_t m = monoRam.level(px, py);
+      uint8_t g = grayRam.level(px, py);
+      if (m == 15) {
+        lit++;
+        wrong += g != 15;
+      } else if (m != 0) {
+        wrong++;   // the mono send has only 0 and 15
+      } else if (g > 0) {
+        bool neighbour = false;
+        for (int dy = -1; dy <= 1; dy++) {
+          for (int dx = -1; dx <= 1; dx++) {
+            int nx = px + dx, ny = py + dy;
+            if (nx >= 0 && nx < 128 && ny >= 0 && ny < 128 && monoRam.level(nx, ny) == 15) {
+              neighbour = true;
+            }
+          }
+        }
+        edges++;
+        wrong += g >= 15 || !neighbour;
+      }
+    }
+  }
+  printf("%-8s font %d: %5d lit, %5d edge pixels, %d wrong\n", s, font, lit, edges, wrong);
+  CHECK(lit > 0);
+  CHECK(edges > 0);
+  CHECK(wrong == 0);
+}
+
+int main() {
+  CHECK(u8g2.isGray4());
+  oledWrapper.startup();
+  mono.begin();
+  captureSends();
+  const u8g2_cb_t* rotations[] = { U8G2_R0, U8G2_R1, U8G2_R2, U8G2_R3 };
+  for (const u8g2_cb_t* rotation : rotations) {
+    compare("42", 3, 0, 0, rotation);
+    compare("1:07", 3, 5, 40, rotation);
+    compare("Hello", 1, 10, 100, rotation);
+  }
+  mock::i2cHook = nullptr;
+  return testResult();
+}
@@ -0,0 +1,89 @@
+// Counts the heap use of a host test. malloc(), calloc(), realloc() and
+// free() are wrapped by the linker (HEAP_COUNT_LINK_OPTIONS in
+// CMakeLists.txt), which covers the firmware, the mock and the libraries.
+// operator new and delete are replaced and go to the wrapped malloc() and
+// free(), which covers std::string and the containers. The String of the
+// mock keeps short strings inline (std::string), on the device each String
+// allocates, mock::strings counts them separately.
+// A test includes this header once, after firmware.h.
+#pragma once
+#include <malloc.h>
+#include <new>
+#include <stdlib.h>
+
+namespace heap {
+  uint64_t allocs;        // malloc, calloc, realloc and new
+  int64_t liveBytes;      // allocated and not freed, malloc_usable_size()
+}
+
+extern "C" {
+void* __real_malloc(size_t n);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* p, size_t n);
+void __real_free(void* p);
+
+void* __wrap_malloc(size_t n) {
+  void* p = __real_malloc(n);
+  if (p) {
+    heap::allocs++;
+    heap::liveBytes += malloc_usable_size(p);
+  }
+  return p;
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+  void* p = __real_calloc(n, size);
+  if (p) {
+    heap::allocs++;
+    heap::liveBytes += malloc_usable_size(p);
+  }
+  return p;
+}
+
+void* __wrap_realloc(void* p, size_t n) {
+  size_t old = p ? malloc_usable_size(p) : 0;
+  void* q = __real_realloc(p, n);
+  if (q) {
+    heap::allocs++;
+    heap::liveBytes += (int64_t)malloc_usable_size(q) - (int64_t)old;
+  } else if (n == 0) {
+    heap::liveBytes -= old;
+  }
+  return q;
+}
+
+void __wrap_free(void* p) {
+  if (p) {
+    heap::liveBytes -= malloc_usable_size(p);
+  }
+  __real_free(p);
+}
+}
+
+void* operator new(size_t n) {
+  void* p = malloc(n ? n : 1);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void* operator new[](size_t n) {
+  return operator new(n);
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+  free(p);
+}
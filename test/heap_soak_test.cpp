@@ -0,0 +1,130 @@
+// Runs setup() and loop() over simulated weeks and checks that the heap in
+// use (test/heap_count.h) stays flat. Each simulated day has a machine run
+// of two hours with alwaysPublish, hourly GetData and GetSetting commands,
+// changes of the channels, the filter and the samples, and an hour without
+// cloud, whose records the offline store replays. Of each minute the first
+// LOOPS_PER_MINUTE loops are run, then the time jumps to the next minute.
+// The 56 days cross the wrap of the 32 bit millis() after 49.7 days.
+//
+// usage: heap_soak_test [-d days]
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "firmware.h"
+#include "heap_count.h"
+
+static const uint64_t SECOND = 1000000;
+static const uint64_t MINUTE = 60 * SECOND;
+static const uint64_t HOUR = 60 * MINUTE;
+static const uint64_t DAY = 24 * HOUR;
+static const int LOOPS_PER_MINUTE = 10;
+static const uint64_t ADC_READ_MICROS = 10;
+
+static bool running;
+static int32_t quietLevel;
+
+// Raw ADC level of an unknown device, a 50 Hz vibration while running.
+static int32_t level(uint64_t us) {
+  int32_t l = quietLevel + rand() % 5 - 2;
+  if (running) {
+    l += (int32_t)(150 * fabs(sin(2 * M_PI * 50 * us / 1e6)));
+  }
+  return l;
+}
+
+static uint64_t published;
+
+// The mock keeps every publish and the serial output, drop them so that only
+// the firmware is counted.
+static void dropMockOutput() {
+  published += mock::publishes.size();
+  mock::publishes.clear();
+  mock::publishes.shrink_to_fit();
+  mock::serialOut.clear();
+  mock::serialOut.shrink_to_fit();
+}
+
+static void hourly(int hour) {
+  static const char* settings[] = { "", "time", "sensor", "oled", "render", "heap", "offline", "bad" };
+  running = hour >= 8 && hour < 10;
+  mock::cloudConnected = hour != 13;
+  if (hour == 8) {
+    setAlwaysPublishData("");
+  }
+  sample_and_publish("");
+  publish_settings(settings[hour % 8]);
+  switch (hour) {
+    case 15: set_channels("3"); set_channel_params("2,100,200,3000"); break;
+    case 16: set_filter("4,6"); break;
+    case 17: set_samples("200,2000"); break;
+    case 18: set_channels("1"); set_filter("1,0"); set_samples("100,1000"); break;
+  }
+}
+
+int main(int argc, char** argv) {
+  int days = 56;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+      days = atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "usage: %s [-d days]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  // Utils::getDeviceBaseline() makes Strings, once for the test
+  quietLevel = Utils::getDeviceBaseline() + Utils::getDeviceZeroCorrection();
+  mock::analogReadHook = [](pin_t) {
+    mock::nowMicros += ADC_READ_MICROS;
+    return level(mock::nowMicros);
+  };
+  firmwareSetup();
+
+  uint64_t start = mock::nowMicros;
+  int64_t dayOneBytes = 0;
+  int64_t maxGrowth = 0;
+  uint64_t allocs = heap::allocs;
+  uint64_t strings = mock::strings;
+  uint64_t dayTwoPublishes = 0;
+  int sameDays = 0;
+  printf("%-5s %12s %12s %12s %12s\n", "day", "live bytes", "allocations", "Strings", "millis()");
+  for (int day = 0; day < days; day++) {
+    for (int hour = 0; hour < 24; hour++) {
+      hourly(hour);
+      for (int minute = 0; minute < 60; minute++) {
+        uint64_t next = start + day * DAY + hour * HOUR + (minute + 1) * MINUTE;
+        for (int i = 0; i < LOOPS_PER_MINUTE && mock::nowMicros < next; i++) {
+          firmwareLoop();
+        }
+        if (mock::nowMicros < next) {
+          mock::nowMicros = next;
+        }
+      }
+      dropMockOutput();
+    }
+    int64_t live = heap::liveBytes;
+    if (day == 0) {
+      dayOneBytes = live;
+    } else {
+      maxGrowth = std::max(maxGrowth, live - dayOneBytes);
+    }
+    // every day after the first publishes the same, also after the wrap
+    if (day == 1) {
+      dayTwoPublishes = published;
+    }
+    sameDays += day >= 1 && published == dayTwoPublishes;
+    published = 0;
+    if (day % 7 == 0 || day == days - 1) {
+      printf("%-5d %12lld %12llu %12llu %12lu\n", day + 1, (long long)live,
+          (unsigned long long)(heap::allocs - allocs), (unsigned long long)(mock::strings - strings),
+          (unsigned long)millis());
+    }
+    allocs = heap::allocs;
+    strings = mock::strings;
+  }
+  printf("heap growth after day 1: %lld bytes\n", (long long)maxGrowth);
+  CHECK(maxGrowth == 0);
+  CHECK(sameDays == days - 1);
+  CHECK(days < 50 || System.millis() > UINT32_MAX);    // millis() wrapped
+  return testResult();
+}
@@ -0,0 +1,283 @@
+/*
+
+  host_font_gen.c
+
+  The u8g2 fonts (u8g2_fonts.c) are not part of this tree, the Particle
+  build takes them from the U8g2 library dependency. For the host build,
+  this program converts the 8x8 u8x8 font u8x8_font_chroma48medium8_r into
+  u8g2 fonts and writes them as C source to stdout:
+
+    u8g2_font_host8x8_tr	ASCII 32..127, the text font of the benchmark
+    u8g2_font_fur49_tn		stand-in for the firmware digits: the 8x8
+				glyphs of " +,-./0123456789:" scaled by 6
+    u8g2_font_ncenB14_tr	stand-in for the firmware text font: ASCII
+				32..127 scaled by 2
+
+  The glyphs are encoded like bdfconv does for the "t" (transparent,
+  proportional) build mode: cropped bounding box, run length encoded
+  pairs of 0 and 1 runs, no repeat compression.
+
+*/
+
+#include "u8g2.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#define MAX_FONT 8192
+#define FONT_HEADER_SIZE 23		/* U8G2_FONT_DATA_STRUCT_SIZE in u8g2_font.c */
+
+struct font_writer
+{
+  uint8_t data[MAX_FONT];
+  size_t len;
+  uint8_t bit_pos;
+};
+
+static void fw_byte(struct font_writer *w, uint8_t b)
+{
+  if ( w->len >= MAX_FONT )
+  {
+    fprintf(stderr, "host_font_gen: font too large\n");
+    exit(1);
+  }
+  w->data[w->len++] = b;
+  w->bit_pos = 0;
+}
+
+/* LSB first, like u8g2_font_decode_get_unsigned_bits() reads them */
+static void fw_bits(struct font_writer *w, unsigned v, uint8_t cnt)
+{
+  while( cnt > 0 )
+  {
+    if ( w->bit_pos == 0 )
+      fw_byte(w, 0);
+    if ( v & 1 )
+      w->data[w->len-1] |= 1 << w->bit_pos;
+    v >>= 1;
+    cnt--;
+    w->bit_pos = (w->bit_pos + 1) & 7;
+  }
+}
+
+static void fw_signed_bits(struct font_writer *w, int v, uint8_t cnt)
+{
+  fw_bits(w, v + (1 << (cnt - 1)), cnt);
+}
+
+static uint8_t bits_for_unsigned(unsigned v)
+{
+  uint8_t n = 1;
+  while( (1U << n) <= v )
+    n++;
+  return n;
+}
+
+static uint8_t bits_for_signed(int min, int max)
+{
+  uint8_t n = 2;
+  while( min < -(1 << (n - 1)) || max >= (1 << (n - 1)) )
+    n++;
+  return n;
+}
+
+/* pixel of the u8x8 glyph, scaled, row 0 is the top */
+static const uint8_t *src_font;
+static int scale;
+
+static int cell(void)
+{
+  return 8 * scale;
+}
+
+static int get_pixel(int encoding, int x, int y)
+{
+  const uint8_t *tile = src_font + 4 + (encoding - src_font[0]) * 8;
+  x /= scale;
+  y /= scale;
+  return (tile[x] >> y) & 1;
+}
+
+struct glyph
+{
+  int encoding;
+  int w, h, x, y, dx;	/* bounding box and offsets as u8g2 stores them */
+  int x0, y0;		/* top left of the bounding box in the cell */
+};
+
+/* the bottom row of the cell is the descent, one row of the source glyph */
+static void get_glyph(int encoding, struct glyph *g)
+{
+  int x, y, x0 = cell(), y0 = cell(), x1 = -1, y1 = -1;
+  for( y = 0; y < cell(); y++ )
+    for( x = 0; x < cell(); x++ )
+      if ( get_pixel(encoding, x, y) )
+      {
+	if ( x < x0 ) x0 = x;
+	if ( x > x1 ) x1 = x;
+	if ( y < y0 ) y0 = y;
+	if ( y > y1 ) y1 = y;
+      }
+  g->encoding = encoding;
+  g->dx = cell();
+  if ( x1 < 0 )
+  {
+    g->w = g->h = g->x = g->y = 0;
+    g->x0 = g->y0 = 0;
+    return;
+  }
+  g->w = x1 - x0 + 1;
+  g->h = y1 - y0 + 1;
+  g->x = x0;
+  g->y = (cell() - scale - 1) - y1;
+  g->x0 = x0;
+  g->y0 = y0;
+}
+
+struct params
+{
+  uint8_t bits_per_0, bits_per_1;
+  uint8_t bits_w, bits_h, bits_x, bits_y, bits_dx;
+};
+
+static void write_glyph(struct font_writer *w, const struct glyph *g, const struct params *p)
+{
+  size_t start;
+  int i, n, a, b, max0, max1;
+
+  fw_byte(w, g->encoding);
+  fw_byte(w, 0);		/* size, set below */
+  start = w->len - 2;
+  fw_bits(w, g->w, p->bits_w);
+  fw_bits(w, g->h, p->bits_h);
+  fw_signed_bits(w, g->x, p->bits_x);
+  fw_signed_bits(w, g->y, p->bits_y);
+  fw_signed_bits(w, g->dx, p->bits_dx);
+
+  max0 = (1 << p->bits_per_0) - 1;
+  max1 = (1 << p->bits_per_1) - 1;
+  n = g->w * g->h;
+  i = 0;
+  while( i < n )
+  {
+    a = 0;
+    while( i < n && a < max0 && !get_pixel(g->encoding, g->x0 + i % g->w, g->y0 + i / g->w) )
+      a++, i++;
+    b = 0;
+    while( i < n && b < max1 && get_pixel(g->encoding, g->x0 + i % g->w, g->y0 + i / g->w) )
+      b++, i++;
+    fw_bits(w, a, p->bits_per_0);
+    fw_bits(w, b, p->bits_per_1);
+    fw_bits(w, 0, 1);		/* no repeat */
+  }
+
+  if ( w->len - start > 255 )
+  {
+    fprintf(stderr, "host_font_gen: glyph %d too large\n", g->encoding);
+    exit(1);
+  }
+  w->data[start + 1] = w->len - start;
+}
+
+static void put_word(uint8_t *p, unsigned v)
+{
+  p[0] = v >> 8;
+  p[1] = v & 255;
+}
+
+static void write_font(const char *name, const char *encodings, int glyph_scale)
+{
+  static struct glyph glyphs[256];
+  struct font_writer w;
+  struct params p;
+  int cnt = 0, i, max_w = 0, max_h = 0, min_x = 0, max_x = 0, min_y = 0, max_y = 0, max_dx = 0;
+  int ascent = 0, descent = 0;
+  size_t pos_A = 0, pos_a = 0, end;
+
+  src_font = u8x8_font_chroma48medium8_r;
+  scale = glyph_scale;
+  for( i = 0; encodings[i] != '\0'; i++ )
+  {
+    struct glyph *g = glyphs + cnt++;
+    get_glyph((uint8_t)encodings[i], g);
+    if ( g->w > max_w ) max_w = g->w;
+    if ( g->h > max_h ) max_h = g->h;
+    if ( g->x < min_x ) min_x = g->x;
+    if ( g->x > max_x ) max_x = g->x;
+    if ( g->y < min_y ) min_y = g->y;
+    if ( g->y > max_y ) max_y = g->y;
+    if ( g->dx > max_dx ) max_dx = g->dx;
+    if ( g->h + g->y > ascent ) ascent = g->h + g->y;
+    if ( g->w > 0 && g->y < descent ) descent = g->y;
+  }
+
+  p.bits_per_0 = glyph_scale > 1 ? 6 : 3;
+  p.bits_per_1 = glyph_scale > 1 ? 6 : 3;
+  p.bits_w = bits_for_unsigned(max_w);
+  p.bits_h = bits_for_unsigned(max_h);
+  p.bits_x = bits_for_signed(min_x, max_x);
+  p.bits_y = bits_for_signed(min_y, max_y);
+  p.bits_dx = bits_for_signed(0, max_dx);
+
+  memset(&w, 0, sizeof(w));
+  w.len = FONT_HEADER_SIZE;
+  for( i = 0; i < cnt; i++ )
+  {
+    if ( pos_A == 0 && glyphs[i].encoding >= 'A' )
+      pos_A = w.len - FONT_HEADER_SIZE;
+    if ( pos_a == 0 && glyphs[i].encoding >= 'a' )
+      pos_a = w.len - FONT_HEADER_SIZE;
+    write_glyph(&w, glyphs + i, &p);
+  }
+  end = w.len - FONT_HEADER_SIZE;
+  if ( pos_A == 0 ) pos_A = end;
+  if ( pos_a == 0 ) pos_a = end;
+  fw_byte(&w, 0);		/* end of the glyph list */
+  fw_byte(&w, 0);
+  /* unicode: one lookup entry, which ends at the empty glyph list behind it */
+  fw_byte(&w, 0); fw_byte(&w, 4);
+  fw_byte(&w, 0xff); fw_byte(&w, 0xff);
+  fw_byte(&w, 0); fw_byte(&w, 0);
+
+  w.data[0] = cnt;
+  w.data[1] = 0;		/* proportional */
+  w.data[2] = p.bits_per_0;
+  w.data[3] = p.bits_per_1;
+  w.data[4] = p.bits_w;
+  w.data[5] = p.bits_h;
+  w.data[6] = p.bits_x;
+  w.data[7] = p.bits_y;
+  w.data[8] = p.bits_dx;
+  w.data[9] = max_w;
+  w.data[10] = max_h;
+  w.data[11] = (uint8_t)(int8_t)min_x;
+  w.data[12] = (uint8_t)(int8_t)min_y;
+  w.data[13] = ascent;		/* no 'A' in the digit fonts, the ascent of all glyphs */
+  w.data[14] = (uint8_t)(int8_t)descent;
+  w.data[15] = ascent;
+  w.data[16] = (uint8_t)(int8_t)descent;
+  put_word(w.data + 17, pos_A);
+  put_word(w.data + 19, pos_a);
+  put_word(w.data + 21, end + 2);
+
+  printf("const uint8_t %s[%u] U8G2_FONT_SECTION(\"%s\") = {", name, (unsigned)w.len, name);
+  for( i = 0; i < (int)w.len; i++ )
+    printf("%s%u,", i % 20 == 0 ? "\n  " : "", w.data[i]);
+  printf("\n};\n\n");
+}
+
+int main(void)
+{
+  char ascii[97];
+  int i;
+  for( i = 0; i < 96; i++ )
+    ascii[i] = 32 + i;
+  ascii[96] = '\0';
+
+  printf("/* generated by host_font_gen from u8x8_font_chroma48medium8_r, do not edit */\n\n");
+  printf("#include \"u8g2.h\"\n\n");
+  write_font("u8g2_font_host8x8_tr", ascii, 1);
+  write_font("u8g2_font_fur49_tn", " +,-./0123456789:", 6);
+  write_font("u8g2_font_ncenB14_tr", ascii, 2);
+  return 0;
+}
@@ -0,0 +1,73 @@
+// Replays a vibration trace through setup() and loop(): quiet, the machine
+// running for two minutes, quiet again. Compares the CPU duty (the time not
+// spent in delay()) of the idle and active phases and checks that the start
+// of the machine is detected within a few idle periods.
+#include <math.h>
+#include "firmware.h"
+
+static const uint64_t SECOND = 1000000;
+static const uint64_t RUN_START = 180 * SECOND;
+static const uint64_t RUN_END = 300 * SECOND;
+static const uint64_t TRACE_END = 480 * SECOND;
+static const uint64_t ADC_READ_MICROS = 10;   // analogRead() on the Photon, about
+
+// Raw ADC level: the baseline plus zero correction of an unknown device with a
+// little noise, while running a 50 Hz vibration on top.
+static int32_t traceLevel(uint64_t us) {
+  int32_t level = Utils::getDeviceBaseline() + Utils::getDeviceZeroCorrection() + rand() % 5 - 2;
+  if (us >= RUN_START && us < RUN_END) {
+    level += (int32_t)(150 * fabs(sin(2 * M_PI * 50 * us / 1e6)));
+  }
+  return level;
+}
+
+static bool activeMode() {
+  sensorhandler.publishJson();
+  return mock::publishes.back().data.find("\"activeMode\":\"true\"") != std::string::npos;
+}
+
+struct Phase {
+  const char* name;
+  uint64_t from, to;
+  double duty;
+};
+
+int main() {
+  mock::analogReadHook = [](pin_t) {
+    mock::nowMicros += ADC_READ_MICROS;
+    return traceLevel(mock::nowMicros);
+  };
+  mock::nowMicros = 0;
+  firmwareSetup();
+
+  // the boot starts in active mode, it ends ACTIVE_HOLD_MS (60 s) after boot and after the run
+  Phase phases[] = {
+    { "idle before", 70 * SECOND, RUN_START, 0 },
+    { "active", RUN_START + SECOND, RUN_END, 0 },
+    { "idle after", RUN_END + 70 * SECOND, TRACE_END, 0 },
+  };
+  uint64_t detected = 0;
+  for (Phase& phase : phases) {
+    while (mock::nowMicros < phase.from) {
+      firmwareLoop();
+      if (detected == 0 && mock::nowMicros >= RUN_START && activeMode()) {
+        detected = mock::nowMicros;
+      }
+    }
+    uint64_t start = mock::nowMicros;
+    uint64_t delayed = mock::delayedMicros;
+    while (mock::nowMicros < phase.to) {
+      firmwareLoop();
+    }
+    phase.duty = 1 - (double)(mock::delayedMicros - delayed) / (mock::nowMicros - start);
+    printf("%-12s duty %5.1f %%\n", phase.name, phase.duty * 100);
+  }
+  printf("run detected after %.1f ms\n", (detected - RUN_START) / 1000.0);
+
+  CHECK(phases[0].duty < 0.1);
+  CHECK(phases[1].duty > 0.9);
+  CHECK(phases[2].duty < 0.1);
+  CHECK(detected >= RUN_START && detected - RUN_START < 150000);
+  CHECK(!activeMode());
+  return testResult();
+}
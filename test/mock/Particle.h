@@ -0,0 +1,354 @@
+// Host mock of the parts of the Particle Device OS API used by the firmware and
+// the display libraries. The functions are implemented in particle_mock.cpp,
+// the mock namespace at the end lets tests drive time, inputs and the buses.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+typedef unsigned char byte;
+typedef uint16_t pin_t;
+enum PinMode { INPUT, OUTPUT, INPUT_PULLUP, INPUT_PULLDOWN };
+enum InterruptMode { CHANGE, RISING, FALLING };
+
+#define HIGH 1
+#define LOW 0
+#define D0 0
+#define D1 1
+#define D2 2
+#define D3 3
+#define D4 4
+#define D5 5
+#define D6 6
+#define D7 7
+#define A0 10
+#define A1 11
+#define A2 12
+#define A3 13
+#define A4 14
+#define A5 15
+#define SCK A3
+#define MISO A4
+#define MOSI A5
+#define DEC 10
+#define HEX 16
+#define PRIVATE 1
+#define PUBLIC 0
+#define TIME_FORMAT_ISO8601_FULL "iso"
+#define SYSTEM_MODE(x)
+#define SYSTEM_THREAD(x)
+#define ATOMIC_BLOCK()
+#define SINGLE_THREADED_BLOCK()
+#define PROGMEM
+#define retained
+#define STARTUP(x)
+#define MSBFIRST 1
+#define LSBFIRST 0
+#define SPI_MODE0 0
+#define SPI_MODE1 1
+#define SPI_MODE2 2
+#define SPI_MODE3 3
+#define SPI_CLOCK_DIV2 2
+#define SPI_CLOCK_DIV4 4
+#define CLOCK_SPEED_100KHZ 100000
+#define CLOCK_SPEED_400KHZ 400000
+
+class String {
+  public:
+    String(const char* s = "");
+    String(const String& s);
+    String(char c);
+    String(int v, unsigned char base = 10);
+    String(unsigned int v, unsigned char base = 10);
+    String(long v, unsigned char base = 10);
+    String(unsigned long v, unsigned char base = 10);
+    String(long long v);
+    String(unsigned long long v);
+    String(float v, int decimals = 2);
+    String(double v, int decimals = 2);
+    ~String();
+    String& operator=(const String& s);
+    String& operator=(const char* s);
+    unsigned char concat(const String& s);
+    unsigned char concat(const char* s);
+    unsigned char concat(char c);
+    unsigned char concat(int v);
+    unsigned char concat(unsigned long v);
+    String& operator+=(const String& s);
+    String& operator+=(const char* s);
+    String& operator+=(char c);
+    char charAt(unsigned int i) const;
+    unsigned int length() const;
+    const char* c_str() const;
+    long toInt() const;
+    float toFloat() const;
+    int compareTo(const String& s) const;
+    unsigned char equals(const String& s) const;
+    unsigned char equals(const char* s) const;
+    bool operator==(const String& s) const;
+    bool operator==(const char* s) const;
+    bool operator!=(const String& s) const { return !(*this == s); }
+    bool operator!=(const char* s) const { return !(*this == s); }
+    String substring(unsigned int from, unsigned int to) const;
+    String substring(unsigned int from) const;
+    int indexOf(char c) const;
+    int indexOf(char c, unsigned int from) const;
+    int indexOf(const char* s) const;
+    unsigned char startsWith(const char* s) const;
+    void toLowerCase();
+    void trim();
+    void reserve(unsigned int size);
+    operator const char*() const;
+    static String format(const char* fmt, ...);
+  private:
+    std::string s_;
+};
+String operator+(const String& a, const String& b);
+String operator+(const char* a, const String& b);
+String operator+(const String& a, const char* b);
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* s);
+    size_t print(const char* s);
+    size_t print(const String& s);
+    size_t print(char c);
+    size_t print(int v, int base = DEC);
+    size_t print(unsigned int v, int base = DEC);
+    size_t print(long v, int base = DEC);
+    size_t print(unsigned long v, int base = DEC);
+    size_t print(double v, int decimals = 2);
+    size_t println();
+    size_t println(const char* s);
+    size_t println(const String& s);
+    size_t println(int v);
+    size_t printf(const char* fmt, ...);
+    size_t printlnf(const char* fmt, ...);
+};
+
+class Stream : public Print {
+  public:
+    virtual int available();
+    virtual int read();
+    virtual int peek();
+    void setTimeout(unsigned long ms);
+};
+
+class USBSerial : public Stream {
+  public:
+    using Print::write;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    void begin(long baud);
+    bool isConnected();
+    operator bool();
+    void flush();
+};
+extern USBSerial Serial;
+
+// Log messages go through the handlers to Serial, like the Device OS
+// StreamLogHandler. Log.info() and friends format the message.
+enum LogLevel {
+  LOG_LEVEL_ALL = 1,
+  LOG_LEVEL_TRACE = 1,
+  LOG_LEVEL_INFO = 30,
+  LOG_LEVEL_WARN = 40,
+  LOG_LEVEL_ERROR = 50,
+  LOG_LEVEL_NONE = 70
+};
+class LogHandler {
+  public:
+    explicit LogHandler(LogLevel level = LOG_LEVEL_INFO);
+    virtual ~LogHandler();
+    LogLevel level() const { return level_; }
+    virtual void logMessage(const char* msg, LogLevel level, const char* category);
+  protected:
+    virtual void write(const char* data, size_t size);
+  private:
+    LogLevel level_;
+};
+class StreamLogHandler : public LogHandler {
+  public:
+    StreamLogHandler(Print& stream, LogLevel level = LOG_LEVEL_INFO);
+  protected:
+    void write(const char* data, size_t size) override;
+  private:
+    Print& stream_;
+};
+class SerialLogHandler : public StreamLogHandler {
+  public:
+    explicit SerialLogHandler(LogLevel level = LOG_LEVEL_INFO);
+};
+class LogManager {
+  public:
+    static LogManager* instance();
+    bool addHandler(LogHandler* handler);
+    void removeHandler(LogHandler* handler);
+    void log(LogLevel level, const char* msg);
+  private:
+    std::mutex lock_;
+    std::vector<LogHandler*> handlers_;
+};
+class Logger {
+  public:
+    void trace(const char* fmt, ...);
+    void info(const char* fmt, ...);
+    void warn(const char* fmt, ...);
+    void error(const char* fmt, ...);
+};
+extern Logger Log;
+
+class TimeClass {
+  public:
+    time_t now();
+    time_t local();
+    String format(time_t t, const char* fmt);
+    String format(const char* fmt);
+    String timeStr();
+    int day(); int day(time_t t);
+    int month(); int month(time_t t);
+    int year(); int year(time_t t);
+    int weekday(); int weekday(time_t t);
+    int hour(); int hour(time_t t);
+    int minute(); int minute(time_t t);
+    int second(); int second(time_t t);
+    void zone(float offset); float zone();
+    void beginDST(); void endDST(); bool isDST();
+    void setDSTOffset(float offset); float getDSTOffset();
+    bool isValid();
+};
+extern TimeClass Time;
+
+class CloudClass {
+  public:
+    bool publish(String name, String data);
+    bool publish(String name, String data, int flags);
+    bool publish(String name, String data, int ttl, int flags);
+    template <class F> bool function(const char* name, F f) { return true; }
+    template <class T> bool variable(const char* name, T value) { return true; }
+    void syncTime();
+    bool syncTimePending();
+    unsigned long timeSyncedLast();
+    bool connected();
+    void process();
+};
+extern CloudClass Particle;
+
+class SystemClass {
+  public:
+    String deviceID();
+    void reset();
+    uint32_t freeMemory();
+    uint32_t ticks();
+    uint32_t ticksPerMicrosecond();
+    uint64_t millis();
+};
+extern SystemClass System;
+
+class Timer {
+  public:
+    typedef void (*timer_callback_fn)(void);
+    Timer(unsigned period, timer_callback_fn callback, bool one_shot = false);
+    template <class T> Timer(unsigned period, void (T::*handler)(), T& instance, bool one_shot = false)
+      : Timer(period, (timer_callback_fn)nullptr, one_shot) {}
+    bool start(); bool stop(); bool reset(); bool changePeriod(unsigned period); bool isActive();
+    bool startFromISR(); bool changePeriodFromISR(unsigned period); bool resetFromISR();
+};
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+int32_t analogRead(pin_t pin);
+void pinMode(pin_t pin, PinMode mode);
+int32_t digitalRead(pin_t pin);
+void digitalWrite(pin_t pin, uint8_t value);
+typedef std::function<void()> wiring_interrupt_handler_t;
+bool attachInterrupt(uint16_t pin, void (*handler)(void), InterruptMode mode, int8_t priority = -1, uint8_t subpriority = 0);
+bool attachInterrupt(uint16_t pin, wiring_interrupt_handler_t handler, InterruptMode mode, int8_t priority = -1, uint8_t subpriority = 0);
+template <typename T>
+bool attachInterrupt(uint16_t pin, void (T::*handler)(), T* instance, InterruptMode mode, int8_t priority = -1, uint8_t subpriority = 0) {
+  return attachInterrupt(pin, wiring_interrupt_handler_t([=]() { (instance->*handler)(); }), mode, priority, subpriority);
+}
+void detachInterrupt(uint16_t pin);
+void noInterrupts();
+void interrupts();
+template <class T> T min(T a, T b) { return a < b ? a : b; }
+template <class T> T max(T a, T b) { return a > b ? a : b; }
+template <class T> T constrain(T a, T l, T h) { return a < l ? l : a > h ? h : a; }
+
+#define EEPROM_SIZE 2047
+class EEPROMClass {
+  public:
+    uint8_t read(int address);
+    void write(int address, uint8_t value);
+    template <class T> T& get(int address, T& t) { memcpy(&t, mem() + address, sizeof(T)); return t; }
+    template <class T> const T& put(int address, const T& t) { memcpy(mem() + address, &t, sizeof(T)); return t; }
+    size_t length();
+    void clear();
+    uint8_t* mem();
+};
+extern EEPROMClass EEPROM;
+
+class SPISettings {
+  public:
+    SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) {}
+};
+class SPIClass {
+  public:
+    void begin(); void begin(uint16_t ss); void end();
+    void setBitOrder(uint8_t order); void setDataMode(uint8_t mode); void setClockDivider(uint8_t divider);
+    void beginTransaction(const SPISettings& settings); void endTransaction();
+    uint8_t transfer(uint8_t data);
+};
+extern SPIClass SPI;
+
+class TwoWire {
+  public:
+    void begin(); void setSpeed(uint32_t speed); void setClock(uint32_t speed);
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t data);
+    size_t write(const uint8_t* data, size_t size);
+    uint8_t endTransmission(); uint8_t endTransmission(uint8_t stop);
+    uint8_t requestFrom(uint8_t address, uint8_t size); int read(); int available();
+};
+extern TwoWire Wire;
+
+namespace mock {
+  // Time of millis(), micros() and System.millis(), in microseconds. delay()
+  // advances it. The 32 bit counters wrap like on the device.
+  extern uint64_t nowMicros;
+  // Called with the new time whenever delay() or delayMicroseconds() advances it.
+  extern std::function<void(uint64_t)> onAdvance;
+  // Sum of all delay() calls, the time the application thread gave away.
+  extern uint64_t delayedMicros;
+  extern std::function<int32_t(pin_t)> analogReadHook;
+  extern std::function<int32_t(pin_t)> digitalReadHook;
+  // Wire: one call per endTransmission() with the address and the bytes written.
+  extern std::function<void(uint8_t, const uint8_t*, size_t)> i2cHook;
+  extern std::function<void(uint8_t)> spiHook;
+  // Everything written to Serial, including the log output.
+  extern std::string serialOut;
+  struct Publish { std::string name, data; };
+  extern std::vector<Publish> publishes;
+  extern bool cloudConnected;
+  // System.deviceID()
+  extern std::string deviceID;
+  extern uint8_t eeprom[EEPROM_SIZE];
+  // String objects constructed. Each one allocates on the device, the mock
+  // keeps short strings inline.
+  extern uint64_t strings;
+  // The handler attached to the pin, empty if none.
+  wiring_interrupt_handler_t interruptHandler(uint16_t pin);
+}
@@ -0,0 +1,383 @@
+// Implementation of the host mock in Particle.h.
+#include "Particle.h"
+#include <stdarg.h>
+#include <ctype.h>
+#include <map>
+#include <thread>
+
+namespace mock {
+  uint64_t nowMicros = 1000000;
+  std::function<void(uint64_t)> onAdvance;
+  uint64_t delayedMicros = 0;
+  std::function<int32_t(pin_t)> analogReadHook;
+  std::function<int32_t(pin_t)> digitalReadHook;
+  std::function<void(uint8_t, const uint8_t*, size_t)> i2cHook;
+  std::function<void(uint8_t)> spiHook;
+  std::string serialOut;
+  std::vector<Publish> publishes;
+  bool cloudConnected = true;
+  std::string deviceID = "000000000000000000000000";
+  uint8_t eeprom[EEPROM_SIZE];
+  uint64_t strings = 0;
+
+  static std::map<uint16_t, wiring_interrupt_handler_t> interrupts;
+
+  wiring_interrupt_handler_t interruptHandler(uint16_t pin) {
+    auto it = interrupts.find(pin);
+    return it == interrupts.end() ? wiring_interrupt_handler_t() : it->second;
+  }
+
+  static void advance(uint64_t us) {
+    nowMicros += us;
+    if (onAdvance) {
+      onAdvance(nowMicros);
+    }
+  }
+
+  static std::string vformat(const char* fmt, va_list args) {
+    char buf[512];
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    return buf;
+  }
+}
+
+// ---- String ----
+String::String(const char* s) : s_(s ? s : "") { mock::strings++; }
+String::String(const String& s) : s_(s.s_) { mock::strings++; }
+String::String(char c) : s_(1, c) { mock::strings++; }
+static std::string toBase(unsigned long long v, unsigned char base, bool negative) {
+  std::string r;
+  do {
+    r.insert(r.begin(), "0123456789abcdefghijklmnopqrstuvwxyz"[v % base]);
+    v /= base;
+  } while (v > 0);
+  return negative ? "-" + r : r;
+}
+String::String(int v, unsigned char base) : s_(base == 10 ? std::to_string(v) : toBase((unsigned)v, base, false)) { mock::strings++; }
+String::String(unsigned int v, unsigned char base) : s_(toBase(v, base, false)) { mock::strings++; }
+String::String(long v, unsigned char base) : s_(base == 10 ? std::to_string(v) : toBase((unsigned long)v, base, false)) { mock::strings++; }
+String::String(unsigned long v, unsigned char base) : s_(toBase(v, base, false)) { mock::strings++; }
+String::String(long long v) : s_(std::to_string(v)) { mock::strings++; }
+String::String(unsigned long long v) : s_(std::to_string(v)) { mock::strings++; }
+String::String(float v, int decimals) : String((double)v, decimals) {}
+String::String(double v, int decimals) {
+  mock::strings++;
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+  s_ = buf;
+}
+String::~String() {}
+String& String::operator=(const String& s) { s_ = s.s_; return *this; }
+String& String::operator=(const char* s) { s_ = s ? s : ""; return *this; }
+unsigned char String::concat(const String& s) { s_ += s.s_; return 1; }
+unsigned char String::concat(const char* s) { s_ += s; return 1; }
+unsigned char String::concat(char c) { s_ += c; return 1; }
+unsigned char String::concat(int v) { return concat(String(v)); }
+unsigned char String::concat(unsigned long v) { return concat(String(v)); }
+String& String::operator+=(const String& s) { concat(s); return *this; }
+String& String::operator+=(const char* s) { concat(s); return *this; }
+String& String::operator+=(char c) { concat(c); return *this; }
+char String::charAt(unsigned int i) const { return i < s_.size() ? s_[i] : 0; }
+unsigned int String::length() const { return s_.size(); }
+const char* String::c_str() const { return s_.c_str(); }
+long String::toInt() const { return atol(s_.c_str()); }
+float String::toFloat() const { return atof(s_.c_str()); }
+int String::compareTo(const String& s) const { return s_.compare(s.s_); }
+unsigned char String::equals(const String& s) const { return s_ == s.s_; }
+unsigned char String::equals(const char* s) const { return s_ == s; }
+bool String::operator==(const String& s) const { return equals(s); }
+bool String::operator==(const char* s) const { return equals(s); }
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > s_.size()) {
+    return String();
+  }
+  return String(s_.substr(from, to > from ? to - from : 0).c_str());
+}
+String String::substring(unsigned int from) const { return substring(from, s_.size()); }
+int String::indexOf(char c) const { size_t i = s_.find(c); return i == std::string::npos ? -1 : (int)i; }
+int String::indexOf(char c, unsigned int from) const { size_t i = s_.find(c, from); return i == std::string::npos ? -1 : (int)i; }
+int String::indexOf(const char* s) const { size_t i = s_.find(s); return i == std::string::npos ? -1 : (int)i; }
+unsigned char String::startsWith(const char* s) const { return s_.compare(0, strlen(s), s) == 0; }
+void String::toLowerCase() { for (char& c : s_) c = tolower(c); }
+void String::trim() {
+  size_t b = s_.find_first_not_of(" \t\r\n");
+  size_t e = s_.find_last_not_of(" \t\r\n");
+  s_ = b == std::string::npos ? "" : s_.substr(b, e - b + 1);
+}
+void String::reserve(unsigned int size) { s_.reserve(size); }
+String::operator const char*() const { return s_.c_str(); }
+String String::format(const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  std::string s = mock::vformat(fmt, args);
+  va_end(args);
+  return String(s.c_str());
+}
+String operator+(const String& a, const String& b) { String r(a); r.concat(b); return r; }
+String operator+(const char* a, const String& b) { String r(a); r.concat(b); return r; }
+String operator+(const String& a, const char* b) { String r(a); r.concat(b); return r; }
+
+// ---- Print, Serial ----
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    write(buffer[i]);
+  }
+  return size;
+}
+size_t Print::write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+size_t Print::print(const char* s) { return write(s); }
+size_t Print::print(const String& s) { return write(s.c_str()); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(int v, int base) { return print(String(v, (unsigned char)base)); }
+size_t Print::print(unsigned int v, int base) { return print(String(v, (unsigned char)base)); }
+size_t Print::print(long v, int base) { return print(String(v, (unsigned char)base)); }
+size_t Print::print(unsigned long v, int base) { return print(String(v, (unsigned char)base)); }
+size_t Print::print(double v, int decimals) { return print(String(v, decimals)); }
+size_t Print::println() { return write("\r\n"); }
+size_t Print::println(const char* s) { return print(s) + println(); }
+size_t Print::println(const String& s) { return print(s) + println(); }
+size_t Print::println(int v) { return print(v) + println(); }
+size_t Print::printf(const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  std::string s = mock::vformat(fmt, args);
+  va_end(args);
+  return write(s.c_str());
+}
+size_t Print::printlnf(const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  std::string s = mock::vformat(fmt, args);
+  va_end(args);
+  return write(s.c_str()) + println();
+}
+int Stream::available() { return 0; }
+int Stream::read() { return -1; }
+int Stream::peek() { return -1; }
+void Stream::setTimeout(unsigned long) {}
+// Each write is atomic, the writes of several threads interleave. Like on the
+// device, where a write waits for room in the USB buffer, the other threads can
+// run between two writes.
+static std::mutex serialLock;
+size_t USBSerial::write(uint8_t c) { return write(&c, 1); }
+size_t USBSerial::write(const uint8_t* buffer, size_t size) {
+  {
+    std::lock_guard<std::mutex> guard(serialLock);
+    mock::serialOut.append((const char*)buffer, size);
+  }
+  std::this_thread::yield();
+  return size;
+}
+void USBSerial::begin(long) {}
+bool USBSerial::isConnected() { return true; }
+USBSerial::operator bool() { return true; }
+void USBSerial::flush() {}
+USBSerial Serial;
+
+// ---- logging ----
+LogHandler::LogHandler(LogLevel level) : level_(level) { LogManager::instance()->addHandler(this); }
+LogHandler::~LogHandler() { LogManager::instance()->removeHandler(this); }
+void LogHandler::logMessage(const char* msg, LogLevel level, const char* category) {
+  char prefix[48];
+  snprintf(prefix, sizeof(prefix), "%010lu [%s] %s: ", millis(), category,
+           level >= LOG_LEVEL_ERROR ? "ERROR" : level >= LOG_LEVEL_WARN ? "WARN" : level >= LOG_LEVEL_INFO ? "INFO" : "TRACE");
+  write(prefix, strlen(prefix));
+  write(msg, strlen(msg));
+  write("\r\n", 2);
+}
+void LogHandler::write(const char*, size_t) {}
+StreamLogHandler::StreamLogHandler(Print& stream, LogLevel level) : LogHandler(level), stream_(stream) {}
+void StreamLogHandler::write(const char* data, size_t size) { stream_.write((const uint8_t*)data, size); }
+SerialLogHandler::SerialLogHandler(LogLevel level) : StreamLogHandler(Serial, level) {}
+LogManager* LogManager::instance() {
+  static LogManager manager;
+  return &manager;
+}
+bool LogManager::addHandler(LogHandler* handler) {
+  std::lock_guard<std::mutex> guard(lock_);
+  handlers_.push_back(handler);
+  return true;
+}
+void LogManager::removeHandler(LogHandler* handler) {
+  std::lock_guard<std::mutex> guard(lock_);
+  for (size_t i = 0; i < handlers_.size(); i++) {
+    if (handlers_[i] == handler) {
+      handlers_.erase(handlers_.begin() + i);
+      return;
+    }
+  }
+}
+// Serialized like in Device OS, the handlers are called by one thread at a time
+void LogManager::log(LogLevel level, const char* msg) {
+  std::lock_guard<std::mutex> guard(lock_);
+  for (LogHandler* handler : handlers_) {
+    if (level >= handler->level()) {
+      handler->logMessage(msg, level, "app");
+    }
+  }
+}
+#define MOCK_LOG(name, level) \
+  void Logger::name(const char* fmt, ...) { \
+    va_list args; \
+    va_start(args, fmt); \
+    std::string s = mock::vformat(fmt, args); \
+    va_end(args); \
+    LogManager::instance()->log(level, s.c_str()); \
+  }
+MOCK_LOG(trace, LOG_LEVEL_TRACE)
+MOCK_LOG(info, LOG_LEVEL_INFO)
+MOCK_LOG(warn, LOG_LEVEL_WARN)
+MOCK_LOG(error, LOG_LEVEL_ERROR)
+Logger Log;
+
+// ---- Time, the clock starts at 2026-06-01 00:00:00 UTC ----
+static const time_t START_TIME = 1780272000;
+static float timeZone = 0;
+static float dstOffset = 1;
+static bool dst = false;
+static struct tm timeParts(time_t t) {
+  struct tm parts;
+  gmtime_r(&t, &parts);
+  return parts;
+}
+time_t TimeClass::now() { return START_TIME + (time_t)(mock::nowMicros / 1000000); }
+time_t TimeClass::local() { return now() + (time_t)((timeZone + (dst ? dstOffset : 0)) * 3600); }
+String TimeClass::format(time_t t, const char*) {
+  char buf[32];
+  struct tm parts = timeParts(t);
+  strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &parts);
+  return String(buf);
+}
+String TimeClass::format(const char* fmt) { return format(local(), fmt); }
+String TimeClass::timeStr() { return format(local(), ""); }
+int TimeClass::day() { return day(local()); }
+int TimeClass::day(time_t t) { return timeParts(t).tm_mday; }
+int TimeClass::month() { return month(local()); }
+int TimeClass::month(time_t t) { return timeParts(t).tm_mon + 1; }
+int TimeClass::year() { return year(local()); }
+int TimeClass::year(time_t t) { return timeParts(t).tm_year + 1900; }
+int TimeClass::weekday() { return weekday(local()); }
+int TimeClass::weekday(time_t t) { return timeParts(t).tm_wday + 1; }
+int TimeClass::hour() { return hour(local()); }
+int TimeClass::hour(time_t t) { return timeParts(t).tm_hour; }
+int TimeClass::minute() { return minute(local()); }
+int TimeClass::minute(time_t t) { return timeParts(t).tm_min; }
+int TimeClass::second() { return second(local()); }
+int TimeClass::second(time_t t) { return timeParts(t).tm_sec; }
+void TimeClass::zone(float offset) { timeZone = offset; }
+float TimeClass::zone() { return timeZone; }
+void TimeClass::beginDST() { dst = true; }
+void TimeClass::endDST() { dst = false; }
+bool TimeClass::isDST() { return dst; }
+void TimeClass::setDSTOffset(float offset) { dstOffset = offset; }
+float TimeClass::getDSTOffset() { return dstOffset; }
+bool TimeClass::isValid() { return true; }
+TimeClass Time;
+
+// ---- cloud and system ----
+bool CloudClass::publish(String name, String data) {
+  mock::publishes.push_back({name.c_str(), data.c_str()});
+  return mock::cloudConnected;
+}
+bool CloudClass::publish(String name, String data, int) { return publish(name, data); }
+bool CloudClass::publish(String name, String data, int, int) { return publish(name, data); }
+void CloudClass::syncTime() {}
+bool CloudClass::syncTimePending() { return false; }
+unsigned long CloudClass::timeSyncedLast() { return 0; }
+bool CloudClass::connected() { return mock::cloudConnected; }
+void CloudClass::process() {}
+CloudClass Particle;
+
+String SystemClass::deviceID() { return String(mock::deviceID.c_str()); }
+void SystemClass::reset() {}
+uint32_t SystemClass::freeMemory() { return 60000; }
+uint32_t SystemClass::ticks() { return (uint32_t)(mock::nowMicros * 120); }
+uint32_t SystemClass::ticksPerMicrosecond() { return 120; }
+uint64_t SystemClass::millis() { return mock::nowMicros / 1000; }
+SystemClass System;
+
+Timer::Timer(unsigned, timer_callback_fn, bool) {}
+bool Timer::start() { return true; }
+bool Timer::stop() { return true; }
+bool Timer::reset() { return true; }
+bool Timer::changePeriod(unsigned) { return true; }
+bool Timer::isActive() { return false; }
+bool Timer::startFromISR() { return true; }
+bool Timer::changePeriodFromISR(unsigned) { return true; }
+bool Timer::resetFromISR() { return true; }
+
+// ---- wiring ----
+unsigned long millis() { return (uint32_t)(mock::nowMicros / 1000); }
+unsigned long micros() { return (uint32_t)mock::nowMicros; }
+void delay(unsigned long ms) {
+  mock::delayedMicros += (uint64_t)ms * 1000;
+  mock::advance((uint64_t)ms * 1000);
+}
+void delayMicroseconds(unsigned int us) { mock::advance(us); }
+void yield() {}
+int32_t analogRead(pin_t pin) { return mock::analogReadHook ? mock::analogReadHook(pin) : 0; }
+void pinMode(pin_t, PinMode) {}
+int32_t digitalRead(pin_t pin) { return mock::digitalReadHook ? mock::digitalReadHook(pin) : HIGH; }
+void digitalWrite(pin_t, uint8_t) {}
+bool attachInterrupt(uint16_t pin, void (*handler)(void), InterruptMode mode, int8_t priority, uint8_t subpriority) {
+  return attachInterrupt(pin, wiring_interrupt_handler_t(handler), mode, priority, subpriority);
+}
+bool attachInterrupt(uint16_t pin, wiring_interrupt_handler_t handler, InterruptMode, int8_t, uint8_t) {
+  mock::interrupts[pin] = handler;
+  return true;
+}
+void detachInterrupt(uint16_t pin) { mock::interrupts.erase(pin); }
+void noInterrupts() {}
+void interrupts() {}
+
+uint8_t EEPROMClass::read(int address) { return mock::eeprom[address]; }
+void EEPROMClass::write(int address, uint8_t value) { mock::eeprom[address] = value; }
+size_t EEPROMClass::length() { return EEPROM_SIZE; }
+void EEPROMClass::clear() { memset(mock::eeprom, 0xff, EEPROM_SIZE); }
+uint8_t* EEPROMClass::mem() { return mock::eeprom; }
+EEPROMClass EEPROM;
+
+void SPIClass::begin() {}
+void SPIClass::begin(uint16_t) {}
+void SPIClass::end() {}
+void SPIClass::setBitOrder(uint8_t) {}
+void SPIClass::setDataMode(uint8_t) {}
+void SPIClass::setClockDivider(uint8_t) {}
+void SPIClass::beginTransaction(const SPISettings&) {}
+void SPIClass::endTransaction() {}
+uint8_t SPIClass::transfer(uint8_t data) {
+  if (mock::spiHook) {
+    mock::spiHook(data);
+  }
+  return 0;
+}
+SPIClass SPI;
+
+static uint8_t wireAddress;
+static std::vector<uint8_t> wireData;
+void TwoWire::begin() {}
+void TwoWire::setSpeed(uint32_t) {}
+void TwoWire::setClock(uint32_t) {}
+void TwoWire::beginTransmission(uint8_t address) {
+  wireAddress = address;
+  wireData.clear();
+}
+size_t TwoWire::write(uint8_t data) {
+  wireData.push_back(data);
+  return 1;
+}
+size_t TwoWire::write(const uint8_t* data, size_t size) {
+  wireData.insert(wireData.end(), data, data + size);
+  return size;
+}
+uint8_t TwoWire::endTransmission() {
+  if (mock::i2cHook) {
+    mock::i2cHook(wireAddress, wireData.data(), wireData.size());
+  }
+  return 0;
+}
+uint8_t TwoWire::endTransmission(uint8_t) { return endTransmission(); }
+uint8_t TwoWire::requestFrom(uint8_t, uint8_t) { return 0; }
+int TwoWire::read() { return -1; }
+int TwoWire::available() { return 0; }
+TwoWire Wire;
@@ -0,0 +1,181 @@
+// OfflineStore on a file (test/file_storage.h): the cursor across the wrap of
+// the slots and across reboots, recovery after power cuts in the middle of a
+// record or of the sent sequence number, and the append and replay throughput.
+//   offline_store_test [dir]   the store file goes to dir, default /tmp
+#include <chrono>
+#include <string>
+#include <vector>
+#include "file_storage.h"
+#include "firmware.h"   // after the standard headers, SparkFunMicroOLED.h defines swap()
+
+typedef FileStorage<EEPROM_SIZE> Storage;
+typedef OfflineStore<Storage> Store;
+
+static std::string path;
+
+static Store openStore() {
+  Store store{Storage(path.c_str())};
+  store.begin();
+  return store;
+}
+
+static Store newStore() {
+  Storage storage(path.c_str());
+  CHECK(storage.isOpen());
+  storage.erase();
+  return openStore();
+}
+
+// Replays until nothing is pending, returns the times of the published records.
+static std::vector<uint32_t> replayAll(Store& store) {
+  std::vector<uint32_t> times;
+  mock::cloudConnected = true;
+  for (int batch = 0; store.pending() > 0 && batch < 1000; batch++) {
+    mock::nowMicros += 2000000;   // REPLAY_RATE_IN_MS
+    size_t published = mock::publishes.size();
+    store.replay();
+    if (mock::publishes.size() > published) {
+      const std::string& json = mock::publishes.back().data;
+      for (size_t pos = json.find("\"t\":\""); pos != std::string::npos; pos = json.find("\"t\":\"", pos + 1)) {
+        times.push_back(strtoul(json.c_str() + pos + 5, nullptr, 10));
+      }
+    }
+  }
+  CHECK(store.pending() == 0);
+  return times;
+}
+
+static std::vector<uint32_t> range(uint32_t from, uint32_t to) {
+  std::vector<uint32_t> v;
+  for (uint32_t t = from; t < to; t++) {
+    v.push_back(t);
+  }
+  return v;
+}
+
+template <class S>
+static void append(OfflineStore<S>& store, uint32_t from, uint32_t to) {
+  for (uint32_t t = from; t < to; t++) {
+    store.append(t, t % 1000, t & 1);
+  }
+}
+
+static void testReboot() {
+  Store store = newStore();
+  append(store, 1000, 1005);
+  CHECK(store.pending() == 5);
+  Store rebooted = openStore();
+  CHECK(rebooted.pending() == 5);
+  CHECK(replayAll(rebooted) == range(1000, 1005));
+  CHECK(openStore().pending() == 0);
+}
+
+// More records than slots: the oldest are overwritten, the cursor wraps
+// several times, also across a reboot in the middle of the replay.
+static void testWrap() {
+  const uint32_t n = 3 * Store::CAPACITY + 7;
+  Store store = newStore();
+  append(store, 1, n + 1);
+  CHECK(store.pending() == (uint32_t)Store::CAPACITY);
+  mock::cloudConnected = true;
+  mock::nowMicros += 2000000;
+  store.replay();
+  Store rebooted = openStore();
+  CHECK(rebooted.pending() == (uint32_t)Store::CAPACITY - 12);
+  CHECK(replayAll(rebooted) == range(n + 1 - Store::CAPACITY + 12, n + 1));
+  append(rebooted, n + 1, n + 4);
+  CHECK(replayAll(rebooted) == range(n + 1, n + 4));
+}
+
+// A power cut after each byte of a record: before the last byte, the record is
+// lost, after it the record is there, the earlier records are never damaged.
+// filled is the number of records before, beyond CAPACITY the new record
+// overwrites the oldest, which is lost once the first byte is written.
+static void testPowerCutInAppend(uint32_t filled) {
+  bool full = filled >= (uint32_t)Store::CAPACITY;
+  uint32_t oldest = full ? filled + 1 - Store::CAPACITY : 1;
+  for (int cut = 0; cut <= 12; cut++) {
+    Storage storage(path.c_str());
+    storage.erase();
+    Store store{storage};
+    store.begin();
+    append(store, 1, filled + 1);
+    storage.powerCutAfter(cut);
+    store.append(filled + 1, 1, true);
+
+    Store rebooted = openStore();
+    uint32_t first = full && cut > 0 ? oldest + 1 : oldest;
+    uint32_t last = cut == 12 ? filled + 1 : filled;
+    CHECK(replayAll(rebooted) == range(first, last + 1));
+  }
+}
+
+// A power cut while the sent sequence number is written: the records are
+// published again rather than lost.
+static void testPowerCutInReplay() {
+  for (int cut = 0; cut <= 8; cut++) {
+    Storage storage(path.c_str());
+    storage.erase();
+    Store store{storage};
+    store.begin();
+    append(store, 1, 31);
+    replayAll(store);   // sent 30
+    append(store, 31, 41);
+    storage.powerCutAfter(cut);
+    mock::nowMicros += 2000000;
+    store.replay();     // publishes 31..40, the sent number may be torn
+
+    Store rebooted = openStore();
+    std::vector<uint32_t> times = replayAll(rebooted);
+    if (cut == 0) {
+      CHECK(times == range(31, 41));
+    } else if (cut == 8) {
+      CHECK(times.empty());
+    } else {
+      // a torn number reads as nothing sent and everything still in the
+      // store is sent again; the check word of 30 and 40 differ only in the
+      // first byte, after it the new number is complete
+      CHECK(cut > 4 ? times.empty() : times == range(1, 41));
+    }
+  }
+}
+
+template <class S>
+static void measure(const char* name, OfflineStore<S>& store) {
+  typedef std::chrono::steady_clock clock;
+  const uint32_t n = 20000;
+  clock::time_point start = clock::now();
+  append(store, 1, n + 1);
+  double appendSeconds = std::chrono::duration<double>(clock::now() - start).count();
+  mock::cloudConnected = true;
+  uint32_t records = store.pending();
+  int batches = 0;
+  start = clock::now();
+  while (store.pending() > 0) {
+    mock::nowMicros += 2000000;
+    store.replay();
+    batches++;
+  }
+  double replaySeconds = std::chrono::duration<double>(clock::now() - start).count();
+  printf("%-8s append %9.0f records/s, replay %9.0f records/s (%d batches, %.0f s at the publish rate)\n",
+         name, n / appendSeconds, records / replaySeconds, batches, batches * 2.0);
+}
+
+int main(int argc, char** argv) {
+  path = std::string(argc > 1 ? argv[1] : "/tmp") + "/offline_store_test.bin";
+  mock::cloudConnected = false;
+  testReboot();
+  testWrap();
+  testPowerCutInAppend(20);
+  testPowerCutInAppend(Store::CAPACITY + 3);
+  testPowerCutInReplay();
+
+  Store fileStore = newStore();
+  measure("file", fileStore);
+  EEPROM.clear();
+  OfflineStore<> eepromStore;
+  eepromStore.begin();
+  measure("EEPROM", eepromStore);
+  unlink(path.c_str());
+  return testResult();
+}
@@ -0,0 +1,97 @@
+// Per-sample cost of SensorPipeline<FixedProfile> (the device parameters
+// compiled in) against SensorPipeline<RuntimeProfile> (read from the
+// profile) with the same parameters, for an active burst of 1000 samples,
+// 1 and 4 channels, with and without the filter. Both are called through
+// SensorPipelineBase like SensorHandler does, and must give the same
+// values. analogRead() of the mock reads a table, its call is part of the
+// time per sample in both.
+//
+// usage: pipeline_bench [-t seconds per measurement]
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+#include "firmware.h"
+
+static const int SAMPLES = 1000;
+static const int ROUNDS = 5;
+static int16_t trace[1024];
+static uint32_t traceIndex;
+
+static double nowNs() {
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ns per sample and channel, the best of ROUNDS
+static double measure(SensorPipelineBase& pipeline, SensorChannels& ch, double seconds) {
+  double best = 0;
+  for (int r = 0; r < ROUNDS; r++) {
+    long bursts = 0;
+    double start = nowNs(), end;
+    do {
+      pipeline.sampleMax(SAMPLES, ch);
+      bursts++;
+      end = nowNs();
+    } while (end - start < seconds * 1e9 / ROUNDS);
+    double ns = (end - start) / bursts / SAMPLES / ch.count;
+    if (r == 0 || ns < best) {
+      best = ns;
+    }
+  }
+  return best;
+}
+
+static void configure(SensorChannels& ch, int count, bool filtered) {
+  ch = SensorChannels();
+  ch.count = count;
+  for (int c = 0; c < SensorChannels::MAX_CHANNELS; c++) {
+    ch.baseline[c] = DEVICES[0].baseline;
+  }
+  if (filtered) {
+    ch.decimation = 4;
+    ch.envelopeShift = 6;
+  }
+}
+
+int main(int argc, char** argv) {
+  double seconds = 0.5;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      seconds = atof(argv[++i]);
+    } else {
+      fprintf(stderr, "usage: %s [-t seconds]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  for (int i = 0; i < 1024; i++) {
+    trace[i] = 500 + rand() % 200;
+  }
+  mock::analogReadHook = [](pin_t) -> int32_t {
+    return trace[traceIndex++ & 1023];
+  };
+
+  static_assert(DEVICES[0].fixedProfile, "DEVICES[0] has a FixedProfile");
+  SensorPipeline<DeviceProfile<0>> fixed;
+  SensorPipeline<RuntimeProfile> runtime(RuntimeProfile { A0,
+      DEVICES[0].baseline, DEVICES[0].zeroCorrection, DEVICES[0].maxValue });
+
+  printf("%-9s %-9s %14s %14s %8s\n", "channels", "filter", "fixed ns", "runtime ns", "ratio");
+  for (int count : { 1, 4 }) {
+    for (bool filtered : { false, true }) {
+      SensorChannels a, b;
+      configure(a, count, filtered);
+      configure(b, count, filtered);
+      traceIndex = 0;
+      fixed.sampleMax(SAMPLES, a);
+      traceIndex = 0;
+      runtime.sampleMax(SAMPLES, b);
+      for (int c = 0; c < count; c++) {
+        CHECK(a.value[c] == b.value[c]);
+      }
+      double f = measure(fixed, a, seconds);
+      double r = measure(runtime, b, seconds);
+      printf("%-9d %-9s %14.2f %14.2f %8.2f\n", count, filtered ? "yes" : "no", f, r, r / f);
+    }
+  }
+  return testResult();
+}
@@ -0,0 +1,44 @@
+// The rendering of the firmware doesn't touch the heap: render_sensor(),
+// drawValueAndTime() and displayNumber() are called for changing values
+// and times, and the heap allocations (test/heap_count.h) and the String
+// constructions of the mock must stay at 0. Built for the MicroOLED
+// (render_alloc_test) and for the SSD1327 (render_alloc_ssd1327_test).
+#include "firmware.h"
+#include "heap_count.h"
+
+int main() {
+  // the counters see the allocations
+  uint64_t allocs = heap::allocs;
+  uint64_t strings = mock::strings;
+  int* volatile p = new int(1);    // volatile, the pairs aren't optimized away
+  delete p;
+  void* volatile m = malloc(100);
+  free(m);
+  String s("counted");
+  CHECK(heap::allocs - allocs == 2);
+  CHECK(mock::strings - strings == 1);
+
+  oledWrapper.startup();
+  Utils::alwaysPublishData = true;
+  CHECK(render_sensor(oledWrapper));    // the first call initializes isPhoton07()
+
+  allocs = heap::allocs;
+  strings = mock::strings;
+  int64_t liveBytes = heap::liveBytes;
+  bool rendered = true;
+  for (int i = 0; i < 200; i++) {
+    mock::nowMicros += 37 * 1000000ULL;     // over the minutes, shifts the digits
+    rendered = render_sensor(oledWrapper) && rendered;
+    oledWrapper.drawValueAndTime(i * 997 - 50000, (uint64_t)i * 3600 * 1000 * 7);
+    oledWrapper.displayNumber(i * 131 - 9000);
+    oledWrapper.displayNumber("12345");
+  }
+  CHECK(rendered);
+  printf("%s: %llu allocations, %llu Strings, %lld bytes for 200 renders\n", oledWrapper.name(),
+      (unsigned long long)(heap::allocs - allocs), (unsigned long long)(mock::strings - strings),
+      (long long)(heap::liveBytes - liveBytes));
+  CHECK(heap::allocs == allocs);
+  CHECK(mock::strings == strings);
+  CHECK(heap::liveBytes == liveBytes);
+  return testResult();
+}
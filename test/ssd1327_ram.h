@@ -0,0 +1,60 @@
+// SSD1327 display RAM: 128 rows of 64 bytes, two pixels per byte. The I2C
+// stream of u8x8_cad_ssd13xx_i2c has one command or argument per transfer
+// (control byte 0x00) and data transfers (control byte 0x40). A test passes
+// the transfers of mock::i2cHook to transfer().
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+struct SSD1327Ram {
+  uint8_t ram[128][64] = {};
+  uint8_t cmd = 0;
+  int     args = 0;
+  uint8_t colStart = 0, colEnd = 63, rowStart = 0, rowEnd = 127;
+  uint8_t col = 0, row = 0;
+
+  void command(uint8_t b) {
+    if (args == 0) {
+      cmd = b;
+      args = (b == 0x15 || b == 0x75) ? 2 : -1;   // set column or row address
+      return;
+    }
+    if (args == 2) {
+      (cmd == 0x15 ? colStart : rowStart) = b;
+      args = 1;
+    } else if (args == 1) {
+      (cmd == 0x15 ? colEnd : rowEnd) = b;
+      col = colStart;
+      row = rowStart;
+      args = 0;
+    }
+  }
+  void data(uint8_t b) {
+    ram[row][col] = b;
+    if (++col > colEnd) {
+      col = colStart;
+      if (++row > rowEnd) {
+        row = rowStart;
+      }
+    }
+  }
+  void transfer(const uint8_t* p, size_t n) {
+    if (n == 0) {
+      return;
+    }
+    for (size_t i = 1; i < n; i++) {
+      if (p[0] == 0x40) {
+        data(p[i]);
+      } else {
+        command(p[i]);
+        if (args < 0) {
+          args = 0;   // commands without arguments, not used by the sends
+        }
+      }
+    }
+  }
+  uint8_t level(int x, int y) const {
+    uint8_t b = ram[y][x / 2];
+    return x & 1 ? b & 0x0F : b >> 4;
+  }
+};
@@ -0,0 +1,115 @@
+// The StripChart of the firmware built for the SSD1327 (OLED_SSD1327): the
+// I2C sends are decoded into an emulated display RAM (test/ssd1327_ram.h),
+// which must show the bars of a model in the lower half of the panel after
+// every update. Covered are the partial updates of new samples, the sweep
+// wrapping around the right edge and the full redraw after another screen
+// used the panel. The bytes per update are printed.
+#include "firmware.h"
+#include "ssd1327_ram.h"
+
+static SSD1327Ram ram;
+static uint32_t i2cBytes;
+
+// The model: bar heights of the columns and the empty column at the cursor.
+static uint8_t bars[StripChart::WIDTH];
+static uint8_t cursor;
+
+static void add(StripChart& chart, int value, int maxValue) {
+  chart.add(value, maxValue);
+  value = std::min(std::max(value, 0), maxValue);
+  bars[cursor] = value * StripChart::HEIGHT / maxValue;
+  cursor = (cursor + 1) % StripChart::WIDTH;
+}
+
+// Pixels of the chart area which differ from the model.
+static int wrongPixels() {
+  int wrong = 0;
+  for (int x = 0; x < StripChart::WIDTH; x++) {
+    int h = x == cursor ? 0 : bars[x];
+    for (int y = 0; y < StripChart::HEIGHT; y++) {
+      bool lit = y >= StripChart::HEIGHT - h;
+      wrong += ram.level(x, 128 - StripChart::HEIGHT + y) != (lit ? 15 : 0);
+    }
+  }
+  return wrong;
+}
+
+static uint32_t render(StripChart& chart, uint32_t generation) {
+  i2cBytes = 0;
+  CHECK(chart.render(oledWrapper, generation));
+  return i2cBytes;
+}
+
+int main() {
+  mock::i2cHook = [](uint8_t, const uint8_t* p, size_t n) {
+    ram.transfer(p, n);
+    i2cBytes += n;
+  };
+  oledWrapper.startup();
+  CHECK(StripChart::fits(oledWrapper));
+  StripChart chart;
+  uint32_t generation = 1;
+
+  // the first render draws the empty chart
+  memset(ram.ram, 0x5A, sizeof(ram.ram));
+  uint32_t full = render(chart, generation);
+  CHECK(wrongPixels() == 0);
+  CHECK(!chart.render(oledWrapper, generation));     // nothing new
+
+  // one sample and a few at once
+  add(chart, 500, 1000);
+  uint32_t one = render(chart, generation);
+  CHECK(wrongPixels() == 0);
+  for (int i = 0; i < 5; i++) {
+    add(chart, i * 300 - 100, 1000);    // also below 0 and above the maximum
+  }
+  uint32_t five = render(chart, generation);
+  CHECK(wrongPixels() == 0);
+
+  // sweep over the right edge several times, updates of 1 to 9 samples
+  int updates = 0, wrong = 0;
+  for (int i = 0; i < 400; updates++) {
+    int n = 1 + updates % 9;
+    for (int k = 0; k < n; k++, i++) {
+      add(chart, (i * 37) % 1100, 1000);
+    }
+    render(chart, generation);
+    wrong += wrongPixels();
+  }
+  CHECK(wrong == 0);
+
+  // the sample in the last column, the empty column is the first one
+  while (cursor != StripChart::WIDTH - 1) {
+    add(chart, 700, 1000);
+  }
+  render(chart, generation);
+  add(chart, 900, 1000);
+  uint32_t wrapped = render(chart, generation);
+  CHECK(wrongPixels() == 0);
+
+  // another screen overwrites the panel, the next generation redraws the chart
+  oledWrapper.display("12345", 3);
+  CHECK(wrongPixels() != 0);
+  add(chart, 1000, 1000);
+  uint32_t redraw = render(chart, ++generation);
+  CHECK(wrongPixels() == 0);
+  CHECK(redraw == full);
+
+  // a full frame for comparison
+  i2cBytes = 0;
+  oledWrapper.flush();
+  uint32_t frame = i2cBytes;
+
+  printf("%-24s %8s\n", "update", "bytes");
+  printf("%-24s %8lu\n", "full chart", (unsigned long)full);
+  printf("%-24s %8lu\n", "1 sample", (unsigned long)one);
+  printf("%-24s %8lu\n", "5 samples", (unsigned long)five);
+  printf("%-24s %8lu\n", "1 sample at the edge", (unsigned long)wrapped);
+  printf("%-24s %8lu\n", "full frame", (unsigned long)frame);
+  printf("%d updates checked\n", updates);
+  CHECK(one > 0 && one < full / 8);
+  CHECK(wrapped == 2 * one);      // the tiles of both edges
+  CHECK(full < frame);
+  mock::i2cHook = nullptr;
+  return testResult();
+}
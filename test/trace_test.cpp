@@ -0,0 +1,112 @@
+// The trace dump ("GetSetting trace") while another thread logs to the same
+// Serial, like the system thread does on the device: every dump must come out
+// whole and pass its length and CRC-32 trailer.
+//   trace_test [dir]   also writes dir/trace.bin and dir/trace_damaged.bin
+//                      (one event byte changed) for tools/trace_to_chrome.py
+#include <atomic>
+#include <thread>
+#include "firmware.h"   // after the standard headers, SparkFunMicroOLED.h defines swap()
+
+static const int DUMPS = 20;
+
+static uint32_t crc32(const uint8_t* data, size_t size) {
+  static uint32_t table[256];
+  if (table[1] == 0) {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; k++) {
+        c = c & 1 ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+      }
+      table[i] = c;
+    }
+  }
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < size; i++) {
+    crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+// Number of dumps in out with a valid trailer, the first one at *first.
+static int countValidDumps(const std::string& out, size_t* first) {
+  int valid = 0;
+  for (size_t pos = out.find("TRC2"); pos != std::string::npos; pos = out.find("TRC2", pos + 1)) {
+    const uint8_t* p = (const uint8_t*)out.data() + pos;
+    // header: marker, names, event count
+    size_t len = 5;
+    for (int i = 0; i < p[4] && pos + len < out.size(); i++) {
+      len += strlen((const char*)p + len) + 1;
+    }
+    uint32_t trailer[2];
+    uint32_t events;
+    if (pos + len + 4 > out.size()) {
+      continue;
+    }
+    memcpy(&events, p + len, 4);
+    len += 4 + 8 * (size_t)events;
+    if (pos + len + sizeof(trailer) > out.size()) {
+      continue;
+    }
+    memcpy(trailer, p + len, sizeof(trailer));
+    if (trailer[0] == len && trailer[1] == crc32(p, len)) {
+      if (valid++ == 0) {
+        *first = pos;
+      }
+    }
+  }
+  return valid;
+}
+
+static void writeFile(const std::string& path, const std::string& data) {
+  FILE* f = fopen(path.c_str(), "wb");
+  CHECK(f != nullptr);
+  if (f != nullptr) {
+    fwrite(data.data(), 1, data.size(), f);
+    fclose(f);
+  }
+}
+
+int main(int argc, char** argv) {
+  for (int i = 0; i < 300; i++) {
+    delayMicroseconds(1000 + i);
+    Trace::add(Trace::Id(i % Trace::NUM_IDS), Trace::Phase(i & 1));
+  }
+
+  std::atomic<bool> stop(false);
+  std::atomic<int> logged(0);
+  std::thread systemThread([&]() {
+    while (!stop) {
+      Log.info("system thread message %d", logged.load());
+      logged++;
+    }
+  });
+  while (logged < 10) {
+    std::this_thread::yield();
+  }
+  for (int i = 0; i < DUMPS; i++) {
+    CHECK(app.publish_settings_("trace") == 1);
+    int before = logged;
+    while (logged < before + 5) {
+      std::this_thread::yield();
+    }
+  }
+  stop = true;
+  systemThread.join();
+
+  std::string out = mock::serialOut;
+  size_t first = 0;
+  CHECK(countValidDumps(out, &first) == DUMPS);
+  CHECK(out.find("system thread message") != std::string::npos);
+
+  // a changed byte fails the CRC
+  std::string damaged = out.substr(first);
+  damaged[60] ^= 0x10;
+  size_t unused;
+  CHECK(countValidDumps(damaged, &unused) == DUMPS - 1);
+
+  if (argc > 1) {
+    writeFile(std::string(argv[1]) + "/trace.bin", out.substr(0, first + 2500));
+    writeFile(std::string(argv[1]) + "/trace_damaged.bin", damaged.substr(0, 2500));
+  }
+  return testResult();
+}
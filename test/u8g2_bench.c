@@ -0,0 +1,290 @@
+/*
+
+  u8g2_bench.c
+
+  Rendering benchmark for the host, modelled on the FPS examples
+  (examples/full_buffer/FPS and examples/page_buffer/FPS). The displays
+  are set up with the memory-only callbacks u8x8_byte_empty and
+  u8x8_dummy_cb, so the numbers are the CPU cost of u8g2 without the bus
+  (see u8x8_bus_stats.c for the bus).
+
+  For each display configuration, rotation and primitive, the screen is
+  filled with the primitive on a 16x16 grid. The gauge is a scene which
+  covers the whole screen: a ring, 12 tick dots, a filled ellipse as hub
+  and a RBox label. Reported are
+    fps		frames per second: clear, fill the screen, send the buffer
+		(full buffer) or the firstPage/nextPage loop (page buffer)
+    ns/call	time per call of the primitive, full buffer only
+    /R0		frame time relative to U8G2_R0 (R1..R3 draw horizontal lines
+		as vertical lines in the buffer and vice versa)
+
+  usage: u8g2_bench [-t seconds per measurement] [-p directory for PBM files]
+
+*/
+
+#include "u8g2.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+extern const uint8_t u8g2_font_host8x8_tr[];
+
+struct config
+{
+  const char *name;
+  void (*setup)(u8g2_t *u8g2, const u8g2_cb_t *rotation, u8x8_msg_cb byte_cb, u8x8_msg_cb gpio_and_delay_cb);
+  uint8_t is_full_buffer;
+};
+
+static const struct config configs[] =
+{
+  { "ssd1327_128x128_f", u8g2_Setup_ssd1327_ea_w128128_f, 1 },
+  { "ssd1327_128x128_g4", u8g2_Setup_ssd1327_ea_w128128_g4, 1 },
+  { "ssd1327_128x128_1", u8g2_Setup_ssd1327_ea_w128128_1, 0 },
+  { "ssd1306_64x48_f", u8g2_Setup_ssd1306_64x48_er_f, 1 },
+  { "ssd1306_64x48_1", u8g2_Setup_ssd1306_64x48_er_1, 0 },
+};
+
+static const u8g2_cb_t *rotations[] = { U8G2_R0, U8G2_R1, U8G2_R2, U8G2_R3 };
+
+static const uint8_t xbm_16x16[32] =
+{
+  0xff, 0xff, 0x01, 0x80, 0xfd, 0xbf, 0x05, 0xa0, 0xf5, 0xaf, 0x15, 0xa8, 0xd5, 0xab, 0x55, 0xaa,
+  0x55, 0xaa, 0xd5, 0xab, 0x15, 0xa8, 0xf5, 0xaf, 0x05, 0xa0, 0xfd, 0xbf, 0x01, 0x80, 0xff, 0xff
+};
+
+/* each draw procedure covers one 16x16 cell, returns the number of primitive calls */
+static int draw_box(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y)
+{
+  u8g2_DrawBox(u8g2, x + 1, y + 1, 14, 14);
+  return 1;
+}
+
+static int draw_text(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y)
+{
+  u8g2_DrawStr(u8g2, x, y + 7, "@A");
+  u8g2_DrawStr(u8g2, x, y + 15, "g1");
+  return 2;
+}
+
+static int draw_xbm(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y)
+{
+  u8g2_DrawXBM(u8g2, x, y, 16, 16, xbm_16x16);
+  return 1;
+}
+
+static int draw_xbm_unaligned(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y)
+{
+  u8g2_DrawXBM(u8g2, x + 3, y + 1, 13, 15, xbm_16x16);
+  return 1;
+}
+
+static int draw_circle(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y)
+{
+  u8g2_DrawCircle(u8g2, x + 8, y + 8, 7, U8G2_DRAW_ALL);
+  return 1;
+}
+
+static int draw_disc(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y)
+{
+  u8g2_DrawDisc(u8g2, x + 8, y + 8, 7, U8G2_DRAW_ALL);
+  return 1;
+}
+
+static int draw_polygon(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y)
+{
+  u8g2_ClearPolygonXY();
+  u8g2_AddPolygonXY(u8g2, x + 1, y + 2);
+  u8g2_AddPolygonXY(u8g2, x + 14, y + 1);
+  u8g2_AddPolygonXY(u8g2, x + 10, y + 8);
+  u8g2_AddPolygonXY(u8g2, x + 15, y + 14);
+  u8g2_AddPolygonXY(u8g2, x + 2, y + 13);
+  u8g2_DrawPolygon(u8g2);
+  return 1;
+}
+
+/* tick positions of the gauge, 1/1024 of the radius, every 30 degrees */
+static const int16_t gauge_ticks[12][2] =
+{
+  { 0, -1024 }, { 512, -887 }, { 887, -512 }, { 1024, 0 }, { 887, 512 }, { 512, 887 },
+  { 0, 1024 }, { -512, 887 }, { -887, 512 }, { -1024, 0 }, { -887, -512 }, { -512, -887 }
+};
+
+/* draws the whole screen, x and y are 0 */
+static int draw_gauge(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y)
+{
+  u8g2_uint_t w = u8g2_GetDisplayWidth(u8g2);
+  u8g2_uint_t h = u8g2_GetDisplayHeight(u8g2);
+  u8g2_uint_t cx = x + w / 2, cy = y + h / 2;
+  u8g2_uint_t r = (w < h ? w : h) / 2 - 2;
+  int i;
+  u8g2_DrawCircle(u8g2, cx, cy, r, U8G2_DRAW_ALL);
+  u8g2_DrawCircle(u8g2, cx, cy, r - 1, U8G2_DRAW_ALL);
+  for( i = 0; i < 12; i++ )
+    u8g2_DrawDisc(u8g2, cx + gauge_ticks[i][0] * (r - 6) / 1024, cy + gauge_ticks[i][1] * (r - 6) / 1024, r / 16 + 1, U8G2_DRAW_ALL);
+  u8g2_DrawFilledEllipse(u8g2, cx, cy, r / 4, r / 5, U8G2_DRAW_ALL);
+  u8g2_DrawRBox(u8g2, cx - r / 2, cy + r / 3, r, r / 4 + 2, r / 16 + 1);
+  return 16;
+}
+
+struct primitive
+{
+  const char *name;
+  int (*draw)(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y);
+  uint8_t is_scene;	/* draw is called once for the whole screen */
+};
+
+static const struct primitive primitives[] =
+{
+  { "box", draw_box },
+  { "text", draw_text },
+  { "xbm", draw_xbm },
+  { "xbm_unaligned", draw_xbm_unaligned },
+  { "circle", draw_circle },
+  { "disc", draw_disc },
+  { "polygon", draw_polygon },
+  { "gauge", draw_gauge, 1 },
+};
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* fills the screen, returns the number of primitive calls */
+static int draw_screen(u8g2_t *u8g2, const struct primitive *p)
+{
+  u8g2_uint_t x, y;
+  int calls = 0;
+  u8g2_SetDrawColor(u8g2, u8g2_IsGray4(u8g2) ? 15 : 1);
+  u8g2_SetFont(u8g2, u8g2_font_host8x8_tr);
+  u8g2_SetFontMode(u8g2, 1);
+  if ( p->is_scene )
+    return p->draw(u8g2, 0, 0);
+  for( y = 0; y + 16 <= u8g2_GetDisplayHeight(u8g2); y += 16 )
+    for( x = 0; x + 16 <= u8g2_GetDisplayWidth(u8g2); x += 16 )
+      calls += p->draw(u8g2, x, y);
+  return calls;
+}
+
+static void draw_frame(u8g2_t *u8g2, const struct config *c, const struct primitive *p)
+{
+  if ( c->is_full_buffer )
+  {
+    u8g2_ClearBuffer(u8g2);
+    draw_screen(u8g2, p);
+    u8g2_SendBuffer(u8g2);
+  }
+  else
+  {
+    u8g2_FirstPage(u8g2);
+    do
+    {
+      draw_screen(u8g2, p);
+    } while( u8g2_NextPage(u8g2) );
+  }
+}
+
+static FILE *pbm_file;
+
+static void pbm_out(const char *s)
+{
+  fputs(s, pbm_file);
+}
+
+static void write_pbm(u8g2_t *u8g2, const char *dir, const struct config *c, int r, const struct primitive *p)
+{
+  char path[512];
+  snprintf(path, sizeof(path), "%s/%s_r%d_%s.%s", dir, c->name, r, p->name, u8g2_IsGray4(u8g2) ? "pgm" : "pbm");
+  pbm_file = fopen(path, "w");
+  if ( pbm_file == NULL )
+  {
+    perror(path);
+    exit(1);
+  }
+  u8g2_WriteBufferPBM(u8g2, pbm_out);
+  fclose(pbm_file);
+}
+
+int main(int argc, char **argv)
+{
+  double seconds = 0.25;
+  const char *pbm_dir = NULL;
+  size_t ci, pi;
+  int i, r;
+  double fps_r0[COUNT(primitives)];
+
+  for( i = 1; i < argc; i++ )
+  {
+    if ( strcmp(argv[i], "-t") == 0 && i + 1 < argc )
+      seconds = atof(argv[++i]);
+    else if ( strcmp(argv[i], "-p") == 0 && i + 1 < argc )
+      pbm_dir = argv[++i];
+    else
+    {
+      fprintf(stderr, "usage: %s [-t seconds] [-p pbm_dir]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  printf("%-20s %-3s %-14s %10s %10s %6s\n", "display", "rot", "primitive", "fps", "ns/call", "/R0");
+  for( ci = 0; ci < COUNT(configs); ci++ )
+  for( r = 0; r < 4; r++ )
+  {
+    const struct config *c = configs + ci;
+    u8g2_t u8g2;
+    c->setup(&u8g2, rotations[r], u8x8_byte_empty, u8x8_dummy_cb);
+    u8g2_InitDisplay(&u8g2);
+    u8g2_SetPowerSave(&u8g2, 0);
+
+    for( pi = 0; pi < COUNT(primitives); pi++ )
+    {
+      const struct primitive *p = primitives + pi;
+      double start, end, fps, ns_per_call = 0;
+      long frames = 0;
+
+      start = now_ns();
+      do
+      {
+	draw_frame(&u8g2, c, p);
+	frames++;
+	end = now_ns();
+      } while( end - start < seconds * 1e9 );
+
+      if ( c->is_full_buffer )
+      {
+	long calls = 0;
+	double draw_start = now_ns(), draw_end;
+	u8g2_ClearBuffer(&u8g2);
+	do
+	{
+	  calls += draw_screen(&u8g2, p);
+	  draw_end = now_ns();
+	} while( draw_end - draw_start < seconds * 1e9 );
+	ns_per_call = (draw_end - draw_start) / calls;
+	if ( pbm_dir != NULL )
+	{
+	  u8g2_ClearBuffer(&u8g2);
+	  draw_screen(&u8g2, p);
+	  write_pbm(&u8g2, pbm_dir, c, r, p);
+	}
+      }
+
+      fps = frames * 1e9 / (end - start);
+      if ( r == 0 )
+	fps_r0[pi] = fps;
+      printf("%-20s R%-2d %-14s %10.1f ", c->name, r, p->name, fps);
+      if ( c->is_full_buffer )
+	printf("%10.1f", ns_per_call);
+      else
+	printf("%10s", "-");
+      printf(" %6.2f\n", fps_r0[pi] / fps);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,194 @@
+/*
+
+  u8g2_bitmap_test.c
+
+  Checks the blit path of u8g2_DrawXBM(), u8g2_DrawXBMP() and
+  u8g2_DrawBitmap() (u8g2_blit_vertical_top_lsb() in u8g2_bitmap.c)
+  against drawing the same bitmap row by row with u8g2_DrawHXBM(),
+  u8g2_DrawHXBMP() and u8g2_DrawHorizontalBitmap(), which do not use it.
+
+  Both are drawn on a background pattern, so the solid mode and the draw
+  colors 0 and 2 show, and the tile buffers are compared. Covered are the
+  rotations R0..R3 (the blit is only used for R0), full and page buffers,
+  clip windows, transparent and solid mode, all draw colors and positions
+  that are not byte aligned or negative (they wrap and are left to the
+  row path).
+
+*/
+
+#include "u8g2.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CASES 1500
+
+/* defined in u8g2_bitmap.c, but not declared in u8g2.h */
+void u8g2_DrawHXBM(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, const uint8_t *b);
+void u8g2_DrawHXBMP(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, const uint8_t *b);
+
+struct config
+{
+  const char *name;
+  void (*setup)(u8g2_t *u8g2, const u8g2_cb_t *rotation, u8x8_msg_cb byte_cb, u8x8_msg_cb gpio_and_delay_cb);
+};
+
+static const struct config configs[] =
+{
+  { "ssd1306_128x64_f", u8g2_Setup_ssd1306_128x64_noname_f },
+  { "ssd1306_128x64_2", u8g2_Setup_ssd1306_128x64_noname_2 },
+  { "ssd1306_128x64_1", u8g2_Setup_ssd1306_128x64_noname_1 },
+  { "ssd1306_64x48_f", u8g2_Setup_ssd1306_64x48_er_f },
+  { "ssd1327_128x128_1", u8g2_Setup_ssd1327_ea_w128128_1 },
+};
+
+static const u8g2_cb_t *rotations[] = { U8G2_R0, U8G2_R1, U8G2_R2, U8G2_R3 };
+
+enum { XBM, XBMP, BITMAP };
+
+struct op
+{
+  uint8_t kind;
+  u8g2_uint_t x, y, w, h;	/* w: bytes per row for BITMAP */
+  uint8_t color;
+  uint8_t is_transparent;
+  uint8_t has_clip;
+  u8g2_uint_t clip_x0, clip_y0, clip_x1, clip_y1;
+};
+
+static uint8_t bitmap[40 * 8];
+static uint8_t expected[128 * 128 / 8];
+static uint8_t actual[128 * 128 / 8];
+static uint32_t seed = 1;
+static int fails;
+
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while( 0 )
+
+static uint32_t rnd(uint32_t n)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % n;
+}
+
+static void draw_rows(u8g2_t *u8g2, const struct op *op)
+{
+  u8g2_uint_t i, blen, w;
+  blen = op->kind == BITMAP ? op->w : (op->w + 7) / 8;
+  w = op->kind == BITMAP ? op->w * 8 : op->w;
+  for( i = 0; i < op->h; i++ )
+  {
+    if ( op->kind == XBM )
+      u8g2_DrawHXBM(u8g2, op->x, op->y + i, w, bitmap + i * blen);
+    else if ( op->kind == XBMP )
+      u8g2_DrawHXBMP(u8g2, op->x, op->y + i, w, bitmap + i * blen);
+    else
+      u8g2_DrawHorizontalBitmap(u8g2, op->x, op->y + i, w, bitmap + i * blen);
+  }
+}
+
+static void draw_blit(u8g2_t *u8g2, const struct op *op)
+{
+  if ( op->kind == XBM )
+    u8g2_DrawXBM(u8g2, op->x, op->y, op->w, op->h, bitmap);
+  else if ( op->kind == XBMP )
+    u8g2_DrawXBMP(u8g2, op->x, op->y, op->w, op->h, bitmap);
+  else
+    u8g2_DrawBitmap(u8g2, op->x, op->y, op->w, op->h, bitmap);
+}
+
+/* draws op on the background pattern of each page and copies the pages to image */
+static void render(u8g2_t *u8g2, const struct op *op, int is_blit, uint8_t *image, size_t size)
+{
+  size_t page_size = (size_t)u8g2_GetBufferTileHeight(u8g2) * u8g2_GetBufferTileWidth(u8g2) * 8;
+  size_t offset, i;
+  uint8_t *buf = u8g2_GetBufferPtr(u8g2);
+
+  u8g2_FirstPage(u8g2);
+  do
+  {
+    offset = (size_t)u8g2_GetBufferCurrTileRow(u8g2) * u8g2_GetBufferTileWidth(u8g2) * 8;
+    for( i = 0; i < page_size; i++ )
+      buf[i] = (uint8_t)((offset + i) * 37 + 11);
+    if ( op->has_clip )
+      u8g2_SetClipWindow(u8g2, op->clip_x0, op->clip_y0, op->clip_x1, op->clip_y1);
+    else
+      u8g2_SetMaxClipWindow(u8g2);
+    u8g2_SetDrawColor(u8g2, op->color);
+    u8g2_SetBitmapMode(u8g2, op->is_transparent);
+    if ( is_blit )
+      draw_blit(u8g2, op);
+    else
+      draw_rows(u8g2, op);
+    for( i = 0; i < page_size && offset + i < size; i++ )
+      image[offset + i] = buf[i];
+  } while( u8g2_NextPage(u8g2) );
+}
+
+static u8g2_uint_t position(u8g2_uint_t display_size)
+{
+  switch( rnd(4) )
+  {
+    case 0: return rnd(17);				/* near the start, mostly unaligned */
+    case 1: return display_size - 1 - rnd(20);		/* across the end */
+    case 2: return (u8g2_uint_t)(0 - 1 - rnd(12));	/* negative, wraps */
+    default: return rnd(display_size);
+  }
+}
+
+static void random_op(u8g2_t *u8g2, struct op *op)
+{
+  u8g2_uint_t dw = u8g2_GetDisplayWidth(u8g2);
+  u8g2_uint_t dh = u8g2_GetDisplayHeight(u8g2);
+  op->kind = rnd(3);
+  op->x = position(dw);
+  op->y = position(dh);
+  op->w = op->kind == BITMAP ? 1 + rnd(5) : 1 + rnd(40);
+  op->h = 1 + rnd(40);
+  op->color = rnd(3);
+  op->is_transparent = rnd(2);
+  op->has_clip = rnd(3) == 0;
+  op->clip_x0 = rnd(dw);
+  op->clip_y0 = rnd(dh);
+  op->clip_x1 = op->clip_x0 + 1 + rnd(dw - op->clip_x0);
+  op->clip_y1 = op->clip_y0 + 1 + rnd(dh - op->clip_y0);
+}
+
+static void test_config(const struct config *config, int r)
+{
+  u8g2_t u8g2;
+  struct op op;
+  size_t size;
+  int i, differ = 0;
+
+  config->setup(&u8g2, rotations[r], u8x8_byte_empty, u8x8_dummy_cb);
+  u8g2_InitDisplay(&u8g2);
+  size = (size_t)u8g2_GetBufferTileWidth(&u8g2) * 8 * u8x8_GetRows(u8g2_GetU8x8(&u8g2));
+  CHECK(size <= sizeof(expected));
+  for( i = 0; i < CASES; i++ )
+  {
+    random_op(&u8g2, &op);
+    render(&u8g2, &op, 0, expected, size);
+    render(&u8g2, &op, 1, actual, size);
+    if ( memcmp(expected, actual, size) != 0 )
+    {
+      if ( differ++ < 3 )
+	printf("FAIL %s R%d: kind %d at %d,%d size %dx%d color %d transparent %d clip %d (%d,%d)-(%d,%d)\n",
+	  config->name, r, op.kind, op.x, op.y, op.w, op.h, op.color, op.is_transparent, op.has_clip,
+	  op.clip_x0, op.clip_y0, op.clip_x1, op.clip_y1);
+    }
+  }
+  fails += differ;
+  printf("%-20s R%d %d cases, %d differ\n", config->name, r, CASES, differ);
+}
+
+int main(void)
+{
+  size_t i;
+  int r;
+  for( i = 0; i < sizeof(bitmap); i++ )
+    bitmap[i] = (uint8_t)rnd(256);
+  for( i = 0; i < sizeof(configs) / sizeof(configs[0]); i++ )
+    for( r = 0; r < 4; r++ )
+      test_config(configs + i, r);
+  printf(fails ? "%d FAILED\n" : "all passed\n", fails);
+  return fails != 0;
+}
@@ -0,0 +1,131 @@
+/*
+
+  u8g2_capture_test.c
+
+  Checks u8g2_WriteBufferPBM(): header, line length (at most 70
+  characters) and that the pixels read back match what was drawn, for a
+  1 bit buffer (SSD1306 64x48) and a 4 bit gray buffer (SSD1327 128x128).
+
+*/
+
+#include "u8g2.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char image[200000];
+static size_t image_len;
+static int fails;
+
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while( 0 )
+
+static void out(const char *s)
+{
+  size_t len = strlen(s);
+  if ( image_len + len < sizeof(image) )
+  {
+    memcpy(image + image_len, s, len + 1);
+    image_len += len;
+  }
+}
+
+static int max_line_len(const char *s)
+{
+  int max = 0, len = 0;
+  for( ; *s != '\0'; s++ )
+  {
+    if ( *s == '\n' )
+      len = 0;
+    else if ( ++len > max )
+      max = len;
+  }
+  return max;
+}
+
+/* skips the magic, size and max value, returns the first pixel */
+static const char *parse_header(const char *s, const char *magic, int *w, int *h)
+{
+  int n = 0;
+  CHECK(strncmp(s, magic, 2) == 0);
+  s += 2;
+  if ( strcmp(magic, "P2") == 0 )
+  {
+    int max;
+    CHECK(sscanf(s, "%d %d %d%n", w, h, &max, &n) == 3);
+    CHECK(max == 15);
+  }
+  else
+  {
+    CHECK(sscanf(s, "%d %d%n", w, h, &n) == 2);
+  }
+  return s + n;
+}
+
+static void test_mono(void)
+{
+  u8g2_t u8g2;
+  const char *p;
+  int w, h, x, y;
+
+  u8g2_Setup_ssd1306_64x48_er_f(&u8g2, U8G2_R0, u8x8_byte_empty, u8x8_dummy_cb);
+  u8g2_InitDisplay(&u8g2);
+  u8g2_ClearBuffer(&u8g2);
+  u8g2_DrawBox(&u8g2, 3, 5, 20, 9);
+  u8g2_DrawDisc(&u8g2, 40, 30, 10, U8G2_DRAW_ALL);
+  u8g2_DrawPixel(&u8g2, 63, 47);
+
+  image_len = 0;
+  u8g2_WriteBufferPBM(&u8g2, out);
+  CHECK(max_line_len(image) <= 70);
+  p = parse_header(image, "P1", &w, &h);
+  CHECK(w == 64 && h == 48);
+  for( y = 0; y < h; y++ )
+    for( x = 0; x < w; x++ )
+    {
+      uint8_t *buf = u8g2_GetBufferPtr(&u8g2);
+      int expected = (buf[(y / 8) * 64 + x] >> (y & 7)) & 1;
+      while( *p == ' ' || *p == '\n' )
+	p++;
+      CHECK(*p == '0' + expected);
+      if ( *p != '\0' )
+	p++;
+    }
+  CHECK(image[image_len - 1] == '\n');
+}
+
+static void test_gray(void)
+{
+  u8g2_t u8g2;
+  const char *p;
+  int w, h, x, y, v, n;
+
+  u8g2_Setup_ssd1327_ea_w128128_g4(&u8g2, U8G2_R0, u8x8_byte_empty, u8x8_dummy_cb);
+  u8g2_InitDisplay(&u8g2);
+  u8g2_ClearBuffer(&u8g2);
+  for( x = 0; x < 16; x++ )
+  {
+    u8g2_SetDrawColor(&u8g2, x);
+    u8g2_DrawBox(&u8g2, x * 8, 0, 8, 128 - x * 8);
+  }
+
+  image_len = 0;
+  u8g2_WriteBufferPBM(&u8g2, out);
+  CHECK(max_line_len(image) <= 70);
+  p = parse_header(image, "P2", &w, &h);
+  CHECK(w == 128 && h == 128);
+  for( y = 0; y < h; y++ )
+    for( x = 0; x < w; x++ )
+    {
+      CHECK(sscanf(p, "%d%n", &v, &n) == 1);
+      p += n;
+      CHECK(v == (y < 128 - (x / 8) * 8 ? x / 8 : 0));
+    }
+}
+
+int main(void)
+{
+  test_mono();
+  test_gray();
+  printf(fails ? "%d FAILED\n" : "all passed\n", fails);
+  return fails != 0;
+}
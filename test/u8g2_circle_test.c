@@ -0,0 +1,431 @@
+/*
+
+  u8g2_circle_test.c
+
+  Checks the column rasterizer of u8g2_DrawDisc(), u8g2_DrawFilledEllipse()
+  and u8g2_DrawRBox() against the span based procedures it replaced
+  (copied below as old_*), which drew up to eight overlapping vertical
+  lines per step. The shapes are drawn on a background pattern with the
+  draw colors 0 and 1 and the tile buffers are compared, for all quadrant
+  options, a range of radii, positions across and beyond the display
+  edges, clip windows, the rotations R0..R3 and full and page buffers.
+  Draw color 2 is not compared: the old procedures flipped the pixels
+  of overlapping lines twice.
+
+*/
+
+#include "u8g2.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CASES 1500
+
+struct config
+{
+  const char *name;
+  void (*setup)(u8g2_t *u8g2, const u8g2_cb_t *rotation, u8x8_msg_cb byte_cb, u8x8_msg_cb gpio_and_delay_cb);
+};
+
+static const struct config configs[] =
+{
+  { "ssd1306_128x64_f", u8g2_Setup_ssd1306_128x64_noname_f },
+  { "ssd1306_128x64_2", u8g2_Setup_ssd1306_128x64_noname_2 },
+  { "ssd1306_64x48_1", u8g2_Setup_ssd1306_64x48_er_1 },
+  { "ssd1327_128x128_f", u8g2_Setup_ssd1327_ea_w128128_f },
+};
+
+static const u8g2_cb_t *rotations[] = { U8G2_R0, U8G2_R1, U8G2_R2, U8G2_R3 };
+
+enum { DISC, FILLED_ELLIPSE, RBOX };
+
+struct op
+{
+  uint8_t kind;
+  u8g2_uint_t x, y, rx, ry;	/* RBOX: rx, ry is the size */
+  u8g2_uint_t r;		/* RBOX only */
+  uint8_t option;
+  uint8_t color;
+  uint8_t has_clip;
+  u8g2_uint_t clip_x0, clip_y0, clip_x1, clip_y1;
+};
+
+static uint8_t expected[128 * 128 / 8];
+static uint8_t actual[128 * 128 / 8];
+static uint32_t seed = 1;
+static int fails;
+
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while( 0 )
+
+static uint32_t rnd(uint32_t n)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % n;
+}
+
+/*==============================================*/
+/* the previous procedures of u8g2_circle.c and u8g2_box.c */
+
+static void old_draw_disc_section(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t x0, u8g2_uint_t y0, uint8_t option)
+{
+    /* upper right */
+    if ( option & U8G2_DRAW_UPPER_RIGHT )
+    {
+      u8g2_DrawVLine(u8g2, x0+x, y0-y, y+1);
+      u8g2_DrawVLine(u8g2, x0+y, y0-x, x+1);
+    }
+    
+    /* upper left */
+    if ( option & U8G2_DRAW_UPPER_LEFT )
+    {
+      u8g2_DrawVLine(u8g2, x0-x, y0-y, y+1);
+      u8g2_DrawVLine(u8g2, x0-y, y0-x, x+1);
+    }
+    
+    /* lower right */
+    if ( option & U8G2_DRAW_LOWER_RIGHT )
+    {
+      u8g2_DrawVLine(u8g2, x0+x, y0, y+1);
+      u8g2_DrawVLine(u8g2, x0+y, y0, x+1);
+    }
+    
+    /* lower left */
+    if ( option & U8G2_DRAW_LOWER_LEFT )
+    {
+      u8g2_DrawVLine(u8g2, x0-x, y0, y+1);
+      u8g2_DrawVLine(u8g2, x0-y, y0, x+1);
+    }
+}
+
+static void old_DrawDisc(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t rad, uint8_t option)
+{
+  u8g2_int_t f;
+  u8g2_int_t ddF_x;
+  u8g2_int_t ddF_y;
+  u8g2_uint_t x;
+  u8g2_uint_t y;
+
+  if ( u8g2_IsIntersection(u8g2, x0-rad, y0-rad, x0+rad+1, y0+rad+1) == 0 ) 
+    return;
+
+  f = 1;
+  f -= rad;
+  ddF_x = 1;
+  ddF_y = 0;
+  ddF_y -= rad;
+  ddF_y *= 2;
+  x = 0;
+  y = rad;
+
+  old_draw_disc_section(u8g2, x, y, x0, y0, option);
+  
+  while ( x < y )
+  {
+    if (f >= 0) 
+    {
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+
+    old_draw_disc_section(u8g2, x, y, x0, y0, option);    
+  }
+}
+
+static void old_draw_filled_ellipse_section(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t x0, u8g2_uint_t y0, uint8_t option)
+{
+    if ( option & U8G2_DRAW_UPPER_RIGHT )
+      u8g2_DrawVLine(u8g2, x0+x, y0-y, y+1);
+    if ( option & U8G2_DRAW_UPPER_LEFT )
+      u8g2_DrawVLine(u8g2, x0-x, y0-y, y+1);
+    if ( option & U8G2_DRAW_LOWER_RIGHT )
+      u8g2_DrawVLine(u8g2, x0+x, y0, y+1);
+    if ( option & U8G2_DRAW_LOWER_LEFT )
+      u8g2_DrawVLine(u8g2, x0-x, y0, y+1);
+}
+
+static void old_DrawFilledEllipse(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t rx, u8g2_uint_t ry, uint8_t option)
+{
+  u8g2_uint_t x, y;
+  u8g2_long_t xchg, ychg;
+  u8g2_long_t err;
+  u8g2_long_t rxrx2;
+  u8g2_long_t ryry2;
+  u8g2_long_t stopx, stopy;
+  
+  if ( u8g2_IsIntersection(u8g2, x0-rx, y0-ry, x0+rx+1, y0+ry+1) == 0 ) 
+    return;
+  
+  rxrx2 = rx;
+  rxrx2 *= rx;
+  rxrx2 *= 2;
+  
+  ryry2 = ry;
+  ryry2 *= ry;
+  ryry2 *= 2;
+  
+  x = rx;
+  y = 0;
+  
+  xchg = 1;
+  xchg -= rx;
+  xchg -= rx;
+  xchg *= ry;
+  xchg *= ry;
+  
+  ychg = rx;
+  ychg *= rx;
+  
+  err = 0;
+  
+  stopx = ryry2;
+  stopx *= rx;
+  stopy = 0;
+  
+  while( stopx >= stopy )
+  {
+    old_draw_filled_ellipse_section(u8g2, x, y, x0, y0, option);
+    y++;
+    stopy += rxrx2;
+    err += ychg;
+    ychg += rxrx2;
+    if ( 2*err+xchg > 0 )
+    {
+      x--;
+      stopx -= ryry2;
+      err += xchg;
+      xchg += ryry2;      
+    }
+  }
+
+  x = 0;
+  y = ry;
+  
+  xchg = ry;
+  xchg *= ry;
+  
+  ychg = 1;
+  ychg -= ry;
+  ychg -= ry;
+  ychg *= rx;
+  ychg *= rx;
+  
+  err = 0;
+  
+  stopx = 0;
+
+  stopy = rxrx2;
+  stopy *= ry;
+
+  while( stopx <= stopy )
+  {
+    old_draw_filled_ellipse_section(u8g2, x, y, x0, y0, option);
+    x++;
+    stopx += ryry2;
+    err += xchg;
+    xchg += ryry2;
+    if ( 2*err+ychg > 0 )
+    {
+      y--;
+      stopy -= rxrx2;
+      err += ychg;
+      ychg += rxrx2;
+    }
+  }
+}
+
+static void old_DrawRBox(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h, u8g2_uint_t r)
+{
+  u8g2_uint_t xl, yu;
+  u8g2_uint_t yl, xr;
+
+  if ( u8g2_IsIntersection(u8g2, x, y, x+w, y+h) == 0 ) 
+    return;
+
+  xl = x;
+  xl += r;
+  yu = y;
+  yu += r;
+ 
+  xr = x;
+  xr += w;
+  xr -= r;
+  xr -= 1;
+  
+  yl = y;
+  yl += h;
+  yl -= r; 
+  yl -= 1;
+
+  old_DrawDisc(u8g2, xl, yu, r, U8G2_DRAW_UPPER_LEFT);
+  old_DrawDisc(u8g2, xr, yu, r, U8G2_DRAW_UPPER_RIGHT);
+  old_DrawDisc(u8g2, xl, yl, r, U8G2_DRAW_LOWER_LEFT);
+  old_DrawDisc(u8g2, xr, yl, r, U8G2_DRAW_LOWER_RIGHT);
+
+  {
+    u8g2_uint_t ww, hh;
+
+    ww = w;
+    ww -= r;
+    ww -= r;
+    xl++;
+    yu++;
+    
+    if ( ww >= 3 )
+    {
+      ww -= 2;
+      u8g2_DrawBox(u8g2, xl, y, ww, r+1);
+      u8g2_DrawBox(u8g2, xl, yl, ww, r+1);
+    }
+    
+    hh = h;
+    hh -= r;
+    hh -= r;
+    if ( hh >= 3 )
+    {
+      hh -= 2;
+      u8g2_DrawBox(u8g2, x, yu, w, hh);
+    }
+  }
+}
+
+/*==============================================*/
+
+static void draw(u8g2_t *u8g2, const struct op *op, int is_old)
+{
+  if ( op->kind == DISC )
+    (is_old ? old_DrawDisc : u8g2_DrawDisc)(u8g2, op->x, op->y, op->rx, op->option);
+  else if ( op->kind == FILLED_ELLIPSE )
+    (is_old ? old_DrawFilledEllipse : u8g2_DrawFilledEllipse)(u8g2, op->x, op->y, op->rx, op->ry, op->option);
+  else
+    (is_old ? old_DrawRBox : u8g2_DrawRBox)(u8g2, op->x, op->y, op->rx, op->ry, op->r);
+}
+
+/* draws op on the background pattern of each page and copies the pages to image */
+static void render(u8g2_t *u8g2, const struct op *op, int is_old, uint8_t *image, size_t size)
+{
+  size_t page_size = (size_t)u8g2_GetBufferTileHeight(u8g2) * u8g2_GetBufferTileWidth(u8g2) * 8;
+  size_t offset, i;
+  uint8_t *buf = u8g2_GetBufferPtr(u8g2);
+
+  u8g2_FirstPage(u8g2);
+  do
+  {
+    offset = (size_t)u8g2_GetBufferCurrTileRow(u8g2) * u8g2_GetBufferTileWidth(u8g2) * 8;
+    for( i = 0; i < page_size; i++ )
+      buf[i] = (uint8_t)((offset + i) * 37 + 11);
+    if ( op->has_clip )
+      u8g2_SetClipWindow(u8g2, op->clip_x0, op->clip_y0, op->clip_x1, op->clip_y1);
+    else
+      u8g2_SetMaxClipWindow(u8g2);
+    u8g2_SetDrawColor(u8g2, op->color);
+    draw(u8g2, op, is_old);
+    for( i = 0; i < page_size && offset + i < size; i++ )
+      image[offset + i] = buf[i];
+  } while( u8g2_NextPage(u8g2) );
+}
+
+static u8g2_uint_t position(u8g2_uint_t display_size)
+{
+  switch( rnd(4) )
+  {
+    case 0: return rnd(20);				/* across the start */
+    case 1: return display_size - 1 - rnd(20);		/* across the end */
+    case 2: return (u8g2_uint_t)(0 - 1 - rnd(30));	/* negative, wraps */
+    default: return rnd(display_size);
+  }
+}
+
+static void random_op(u8g2_t *u8g2, struct op *op)
+{
+  u8g2_uint_t dw = u8g2_GetDisplayWidth(u8g2);
+  u8g2_uint_t dh = u8g2_GetDisplayHeight(u8g2);
+  op->kind = rnd(3);
+  op->x = position(dw);
+  op->y = position(dh);
+  op->rx = rnd(41);
+  op->ry = 1 + rnd(40);
+  op->option = 1 + rnd(15);
+  if ( op->kind == FILLED_ELLIPSE && op->rx == 0 )
+    op->rx = 1;
+  if ( op->kind == RBOX )
+  {
+    /* u8g2_DrawRBox() requires w >= 2*(r+1) and h >= 2*(r+1) */
+    op->rx = 2 + rnd(60);
+    op->ry = 2 + rnd(60);
+    op->r = rnd((op->rx < op->ry ? op->rx : op->ry) / 2);
+  }
+  op->color = rnd(2);
+  op->has_clip = rnd(3) == 0;
+  op->clip_x0 = rnd(dw);
+  op->clip_y0 = rnd(dh);
+  op->clip_x1 = op->clip_x0 + 1 + rnd(dw - op->clip_x0);
+  op->clip_y1 = op->clip_y0 + 1 + rnd(dh - op->clip_y0);
+}
+
+static int compare(u8g2_t *u8g2, const struct config *config, int r, const struct op *op, size_t size, int differ)
+{
+  render(u8g2, op, 1, expected, size);
+  render(u8g2, op, 0, actual, size);
+  if ( memcmp(expected, actual, size) == 0 )
+    return 0;
+  if ( differ < 3 )
+    printf("FAIL %s R%d: kind %d at %d,%d rx %d ry %d r %d option %d color %d clip %d (%d,%d)-(%d,%d)\n",
+      config->name, r, op->kind, op->x, op->y, op->rx, op->ry, op->r, op->option, op->color, op->has_clip,
+      op->clip_x0, op->clip_y0, op->clip_x1, op->clip_y1);
+  return 1;
+}
+
+static void test_config(const struct config *config, int r)
+{
+  u8g2_t u8g2;
+  struct op op;
+  size_t size;
+  int i, cases = 0, differ = 0;
+
+  config->setup(&u8g2, rotations[r], u8x8_byte_empty, u8x8_dummy_cb);
+  u8g2_InitDisplay(&u8g2);
+  size = (size_t)u8g2_GetBufferTileWidth(&u8g2) * 8 * u8x8_GetRows(u8g2_GetU8x8(&u8g2));
+  CHECK(size <= sizeof(expected));
+
+  /* every radius and option in the middle of the display */
+  memset(&op, 0, sizeof(op));
+  op.x = u8g2_GetDisplayWidth(&u8g2) / 2;
+  op.y = u8g2_GetDisplayHeight(&u8g2) / 2 + 1;
+  op.color = 1;
+  for( op.rx = 0; op.rx <= 40; op.rx++ )
+    for( op.option = 1; op.option <= U8G2_DRAW_ALL; op.option++ )
+    {
+      op.kind = DISC;
+      differ += compare(&u8g2, config, r, &op, size, differ);
+      cases++;
+      if ( op.rx == 0 )
+	continue;		/* the ellipse procedures do not terminate for rx == 0 or ry == 0 */
+      op.kind = FILLED_ELLIPSE;
+      op.ry = 41 - op.rx;
+      differ += compare(&u8g2, config, r, &op, size, differ);
+      cases++;
+    }
+
+  for( i = 0; i < CASES; i++ )
+  {
+    random_op(&u8g2, &op);
+    differ += compare(&u8g2, config, r, &op, size, differ);
+    cases++;
+  }
+  fails += differ;
+  printf("%-20s R%d %d cases, %d differ\n", config->name, r, cases, differ);
+}
+
+int main(void)
+{
+  size_t i;
+  int r;
+  for( i = 0; i < sizeof(configs) / sizeof(configs[0]); i++ )
+    for( r = 0; r < 4; r++ )
+      test_config(configs + i, r);
+  printf(fails ? "%d FAILED\n" : "all passed\n", fails);
+  return fails != 0;
+}
@@ -0,0 +1,58 @@
+// The firmware built for the SSD1327 (OLED_SSD1327): U8g2Driver draws the text
+// and the digits into the frame buffer and sends it over I2C, without the
+// "Debug" publishes and their delays.
+#include "firmware.h"
+
+static uint32_t i2cBytes;
+
+static int litPixels() {
+  const uint8_t* buf = u8g2.getBufferPtr();
+  int n = 0;
+  for (int i = 0; i < 128 * 128 / 8; i++) {
+    n += __builtin_popcount(buf[i]);
+  }
+  return n;
+}
+
+static bool published(const char* name) {
+  for (const mock::Publish& p : mock::publishes) {
+    if (p.name == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int main() {
+  mock::i2cHook = [](uint8_t, const uint8_t*, size_t n) { i2cBytes += n; };
+  uint64_t delayed = mock::delayedMicros;
+  oledWrapper.startup();
+  CHECK(strcmp(oledWrapper.name(), "U8g2 SSD1327") == 0);
+  CHECK(mock::delayedMicros - delayed < 1000000);
+
+  i2cBytes = 0;
+  oledWrapper.display("42", 3);
+  int digits = litPixels();
+  CHECK(digits > 0);
+  CHECK(i2cBytes >= 128 * 128 / 2);   // the whole frame, 4 bit per pixel
+
+  oledWrapper.display("Hello", 1);
+  int text = litPixels();
+  CHECK(text > 0 && text != digits);
+
+  // the text starts at the top, like on the MicroOLED
+  const uint8_t* buf = u8g2.getBufferPtr();
+  int top = 128;
+  for (int i = 0; i < 128 * 128 / 8; i++) {
+    if (buf[i] != 0) {
+      top = std::min(top, (i / 128) * 8 + __builtin_ctz(buf[i]));
+    }
+  }
+  CHECK(top < 8);
+
+  oledWrapper.clearBuffer();
+  CHECK(litPixels() == 0);
+  CHECK(!published("Debug"));
+  mock::i2cHook = nullptr;
+  return testResult();
+}
@@ -0,0 +1,122 @@
+/*
+
+  u8log_bench.c
+
+  Lines per second of u8log for logs of 16x8 and 32x16 chars. Each line
+  has 15 chars and '\n', so every line scrolls the log once the screen
+  is full. Reported for
+    buffer	u8log without callback: the screen buffer and its scrolling
+    u8x8	u8log_u8x8_cb redraws the changed lines on a memory display
+		(the tiles are copied, there is no bus)
+
+  usage: u8log_bench [-t seconds per measurement]
+
+*/
+
+#include "u8x8.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_WIDTH 32
+#define MAX_HEIGHT 16
+
+static const char line[] = "sensor 0123 ok\n";	/* 15 chars and \n */
+static uint8_t buf[MAX_WIDTH * MAX_HEIGHT];
+static uint8_t tiles[MAX_HEIGHT][MAX_WIDTH][8];
+static u8x8_display_info_t display_info;
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint8_t u8x8_d_memory(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr)
+{
+  u8x8_tile_t *tile = (u8x8_tile_t *)arg_ptr;
+  uint8_t x;
+  switch( msg )
+  {
+    case U8X8_MSG_DISPLAY_SETUP_MEMORY:
+      u8x8_d_helper_display_setup_memory(u8x8, &display_info);
+      break;
+    case U8X8_MSG_DISPLAY_INIT:
+      u8x8_d_helper_display_init(u8x8);
+      break;
+    case U8X8_MSG_DISPLAY_DRAW_TILE:
+      x = tile->x_pos;
+      do
+      {
+	memcpy(tiles[tile->y_pos][x], tile->tile_ptr, tile->cnt * 8);
+	x += tile->cnt;
+	arg_int--;
+      } while( arg_int > 0 );
+      break;
+    default:
+      return 0;
+  }
+  return 1;
+}
+
+enum { BUFFER, U8X8 };
+static const char *names[] = { "buffer", "u8x8" };
+
+static double lines_per_second(uint8_t width, uint8_t height, int mode, double seconds)
+{
+  u8x8_t u8x8;
+  u8log_t u8log;
+  long lines = 0;
+  double start, end;
+
+  memset(&display_info, 0, sizeof(display_info));
+  display_info.tile_width = width;
+  display_info.tile_height = height;
+  display_info.pixel_width = width * 8;
+  display_info.pixel_height = height * 8;
+  u8x8_Setup(&u8x8, u8x8_d_memory, u8x8_cad_empty, u8x8_byte_empty, u8x8_dummy_cb);
+  u8x8_InitDisplay(&u8x8);
+  u8x8_SetFont(&u8x8, u8x8_font_chroma48medium8_r);
+  u8log_Init(&u8log, width, height, buf);
+  if ( mode == U8X8 )
+    u8log_SetCallback(&u8log, u8log_u8x8_cb, &u8x8);
+
+  start = now_ns();
+  do
+  {
+    int i;
+    for( i = 0; i < 100; i++ )
+      u8log_WriteString(&u8log, line);
+    lines += 100;
+    end = now_ns();
+  } while( end - start < seconds * 1e9 );
+  return lines * 1e9 / (end - start);
+}
+
+int main(int argc, char **argv)
+{
+  static const uint8_t sizes[][2] = { { 16, 8 }, { 32, 16 } };
+  double seconds = 0.25;
+  int i, mode;
+  size_t s;
+
+  for( i = 1; i < argc; i++ )
+  {
+    if ( strcmp(argv[i], "-t") == 0 && i + 1 < argc )
+      seconds = atof(argv[++i]);
+    else
+    {
+      fprintf(stderr, "usage: %s [-t seconds]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  printf("%-6s %-8s %14s\n", "log", "mode", "lines/sec");
+  for( s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++ )
+    for( mode = BUFFER; mode <= U8X8; mode++ )
+      printf("%2dx%-3d %-8s %14.0f\n", sizes[s][0], sizes[s][1], names[mode],
+	lines_per_second(sizes[s][0], sizes[s][1], mode, seconds));
+  return 0;
+}
@@ -0,0 +1,280 @@
+/*
+
+  u8log_test.c
+
+  Checks the ring of lines of u8log.c against a plain model, which scrolls
+  by copying the screen like u8log did before: random text and control
+  codes (\n, \r, \t, \f) are written to logs of 16x8, 32x16 and 5x40
+  chars, and the cursor and every screen line (u8log_GetLine()) must match
+  the model after each char.
+
+  The redraw is checked with u8log_u8x8_cb on a memory display, which
+  stores the tiles it gets: when u8log has called back for a new line
+  (or, in the redraw mode for each char, for any char), the display shows
+  the model. This covers the dirty line tracking, scrolling between two
+  callbacks and the logs with more than 32 lines, which redraw all.
+
+*/
+
+#include "u8x8.h"
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_WIDTH 32
+#define MAX_HEIGHT 40
+
+static int fails;
+
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while( 0 )
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(uint32_t n)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % n;
+}
+
+/*==============================================*/
+/* model: screen as array of lines, scrolling copies the lines */
+
+struct model
+{
+  uint8_t width, height;
+  uint8_t x, y;
+  uint8_t screen[MAX_HEIGHT][MAX_WIDTH];
+};
+
+static void model_clear(struct model *m)
+{
+  memset(m->screen, ' ', sizeof(m->screen));
+  m->x = 0;
+  m->y = 0;
+}
+
+static void model_write(struct model *m, uint8_t c)
+{
+  switch( c )
+  {
+    case '\n': m->y++; m->x = 0; break;
+    case '\r': m->x = 0; break;
+    case '\t': m->x = (m->x + 8) & 0xf8; break;
+    case '\f': model_clear(m); break;
+    default:
+      if ( m->x >= m->width )
+      {
+	m->x = 0;
+	m->y++;
+      }
+      while ( m->y >= m->height )
+      {
+	memmove(m->screen[0], m->screen[1], (m->height - 1) * MAX_WIDTH);
+	memset(m->screen[m->height - 1], ' ', MAX_WIDTH);
+	m->y--;
+      }
+      m->screen[m->y][m->x++] = c;
+      break;
+  }
+}
+
+/*==============================================*/
+/* memory display: keeps the tiles it gets */
+
+static uint8_t tiles[MAX_HEIGHT][MAX_WIDTH][8];
+static u8x8_display_info_t display_info;
+
+static uint8_t u8x8_d_memory(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr)
+{
+  u8x8_tile_t *tile = (u8x8_tile_t *)arg_ptr;
+  uint8_t x;
+  switch( msg )
+  {
+    case U8X8_MSG_DISPLAY_SETUP_MEMORY:
+      u8x8_d_helper_display_setup_memory(u8x8, &display_info);
+      break;
+    case U8X8_MSG_DISPLAY_INIT:
+      u8x8_d_helper_display_init(u8x8);
+      break;
+    case U8X8_MSG_DISPLAY_DRAW_TILE:
+      x = tile->x_pos;
+      do
+      {
+	memcpy(tiles[tile->y_pos][x], tile->tile_ptr, tile->cnt * 8);
+	x += tile->cnt;
+	arg_int--;
+      } while( arg_int > 0 );
+      break;
+    default:
+      return 0;
+  }
+  return 1;
+}
+
+static void setup_display(u8x8_t *u8x8, uint8_t width, uint8_t height)
+{
+  memset(&display_info, 0, sizeof(display_info));
+  display_info.tile_width = width;
+  display_info.tile_height = height;
+  display_info.pixel_width = width * 8;
+  display_info.pixel_height = height * 8;
+  u8x8_Setup(u8x8, u8x8_d_memory, u8x8_cad_empty, u8x8_byte_empty, u8x8_dummy_cb);
+  u8x8_InitDisplay(u8x8);
+  u8x8_SetFont(u8x8, u8x8_font_chroma48medium8_r);
+}
+
+/* the display shows the lines of the model */
+static int display_equals(u8x8_t *u8x8, const struct model *m)
+{
+  static uint8_t saved[MAX_HEIGHT][MAX_WIDTH][8];
+  uint8_t x, y;
+  int equal;
+  /* draw the model over a copy of the display and compare */
+  memcpy(saved, tiles, sizeof(tiles));
+  for( y = 0; y < m->height; y++ )
+    for( x = 0; x < m->width; x++ )
+      u8x8_DrawGlyph(u8x8, x, y, m->screen[y][x]);
+  equal = memcmp(saved, tiles, sizeof(tiles)) == 0;
+  memcpy(tiles, saved, sizeof(tiles));
+  return equal;
+}
+
+/*==============================================*/
+
+static int callbacks;
+
+static void count_cb(u8log_t *u8log)
+{
+  callbacks++;
+  u8log_u8x8_cb(u8log);
+}
+
+static uint8_t random_char(void)
+{
+  static const uint8_t controls[] = { '\n', '\n', '\n', '\r', '\t', '\f' };
+  if ( rnd(12) == 0 )
+    return controls[rnd(rnd(20) == 0 ? 6 : 5)];	/* \f seldom */
+  return 'A' + rnd(58);
+}
+
+static void test_random(uint8_t width, uint8_t height, uint8_t is_redraw_line_for_each_char, int chars)
+{
+  static uint8_t buf[MAX_WIDTH * MAX_HEIGHT];
+  u8x8_t u8x8;
+  u8log_t u8log;
+  struct model m;
+  int i, differ = 0, redraws = 0;
+  uint8_t c, y;
+
+  setup_display(&u8x8, width, height);
+  u8log_Init(&u8log, width, height, buf);
+  u8log_SetCallback(&u8log, count_cb, &u8x8);
+  u8log_SetRedrawMode(&u8log, is_redraw_line_for_each_char);
+  memset(&m, 0, sizeof(m));
+  m.width = width;
+  m.height = height;
+  model_clear(&m);
+  u8log_WriteChar(&u8log, '\f');	/* draws the empty screen */
+
+  for( i = 0; i < chars; i++ )
+  {
+    c = random_char();
+    callbacks = 0;
+    u8log_WriteChar(&u8log, c);
+    model_write(&m, c);
+
+    if ( u8log.cursor_x != m.x || u8log.cursor_y != m.y )
+      differ++;
+    for( y = 0; y < height; y++ )
+      if ( memcmp(u8log_GetLine(&u8log, y), m.screen[y], width) != 0 )
+	differ++;
+    CHECK(u8log.first_line < height);
+
+    /* a new line or \f is shown, in the redraw mode for each char every char but \t */
+    if ( c == '\n' || c == '\f' || (is_redraw_line_for_each_char && c != '\t') )
+    {
+      CHECK(callbacks == 1);
+      if ( !display_equals(&u8x8, &m) )
+	differ++;
+      redraws++;
+    }
+  }
+  if ( differ != 0 )
+    printf("FAIL %dx%d mode %d: %d differences\n", width, height, is_redraw_line_for_each_char, differ);
+  fails += differ;
+  printf("%2dx%-2d mode %d: %d chars, %d redraws checked\n", width, height, is_redraw_line_for_each_char, chars, redraws);
+}
+
+/* first_line moves by one for each scroll and wraps at the height */
+static void test_first_line(void)
+{
+  uint8_t buf[16 * 8];
+  u8log_t u8log;
+  int i;
+
+  u8log_Init(&u8log, 16, 8, buf);
+  for( i = 0; i < 8; i++ )
+    u8log_WriteString(&u8log, "line\n");
+  /* the cursor is below the last line, the next char scrolls */
+  CHECK(u8log.cursor_y == 8);
+  CHECK(u8log.first_line == 0);
+  for( i = 1; i <= 20; i++ )
+  {
+    u8log_WriteString(&u8log, "x\n");
+    CHECK(u8log.first_line == i % 8);
+    CHECK(u8log_GetLine(&u8log, 7)[0] == 'x');
+    CHECK(u8log_GetLine(&u8log, 0) == buf + 16 * (i % 8));
+  }
+  /* \f clears the screen and starts at buffer line 0 again */
+  u8log_WriteChar(&u8log, '\f');
+  CHECK(u8log.first_line == 0);
+  CHECK(u8log_GetLine(&u8log, 7)[0] == ' ');
+}
+
+/* between two callbacks only the changed lines are redrawn */
+static int drawn_lines;
+static uint32_t drawn_mask;
+
+static void dirty_cb(u8log_t *u8log)
+{
+  drawn_mask = u8log->dirty_lines;
+  drawn_lines = u8log->is_redraw_all ? u8log->height : __builtin_popcount(u8log->dirty_lines);
+}
+
+static void test_dirty_lines(void)
+{
+  uint8_t buf[16 * 8];
+  u8log_t u8log;
+
+  u8log_Init(&u8log, 16, 8, buf);
+  u8log_SetCallback(&u8log, dirty_cb, NULL);
+  u8log_WriteString(&u8log, "a\n");
+  CHECK(drawn_lines == 1 && drawn_mask == 1);
+  /* \r redraws its line, the next \n the line again */
+  u8log_WriteString(&u8log, "bc\r");
+  CHECK(drawn_lines == 1 && drawn_mask == 2);
+  u8log_WriteString(&u8log, "d\n");
+  CHECK(drawn_lines == 1 && drawn_mask == 2);
+  /* a line longer than the width: both lines */
+  u8log_WriteString(&u8log, "0123456789abcdefXY\n");
+  CHECK(drawn_lines == 2 && drawn_mask == 0x0c);
+  /* after a scroll, the next \n redraws all */
+  u8log_WriteString(&u8log, "\n\n\n\n");
+  u8log_WriteString(&u8log, "e\n");
+  CHECK(drawn_lines == 8);
+  u8log_WriteString(&u8log, "f\n");
+  CHECK(drawn_lines == 8);		/* the cursor was below the screen again */
+}
+
+int main(void)
+{
+  test_first_line();
+  test_dirty_lines();
+  test_random(16, 8, 0, 50000);
+  test_random(16, 8, 1, 50000);
+  test_random(32, 16, 0, 50000);
+  test_random(32, 16, 1, 20000);
+  test_random(5, 40, 0, 20000);
+  test_random(5, 40, 1, 5000);
+  printf(fails ? "%d FAILED\n" : "all passed\n", fails);
+  return fails != 0;
+}
@@ -0,0 +1,140 @@
+/*
+
+  u8x8_glyph_bench.c
+
+  Throughput of the upscaled u8x8 glyphs: u8x8_Draw3x3Glyph() and
+  u8x8_Draw4x4Glyph() (table lookup, one DrawTile per row) against
+  u8x8_Draw2x2Glyph() (u8x8_upscale_byte()), and of the matching string
+  procedures. The display only sums the tiles it gets, so the time is
+  the upscaling and the calls. Reported per glyph, as output tiles per
+  second and relative to 2x2 per output tile.
+
+  usage: u8x8_glyph_bench [-t seconds per measurement]
+
+*/
+
+#include "u8x8.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char *lines[4] = { "01234567", "89ABCDEF", "GHIJKLMN", "OPQRSTUV" };	/* 32 glyphs */
+static u8x8_display_info_t display_info;
+static uint32_t calls, sum;
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint8_t u8x8_d_sum(u8x8_t *u8x8, uint8_t msg, U8X8_UNUSED uint8_t arg_int, void *arg_ptr)
+{
+  u8x8_tile_t *tile = (u8x8_tile_t *)arg_ptr;
+  switch( msg )
+  {
+    case U8X8_MSG_DISPLAY_SETUP_MEMORY:
+      u8x8_d_helper_display_setup_memory(u8x8, &display_info);
+      break;
+    case U8X8_MSG_DISPLAY_INIT:
+      u8x8_d_helper_display_init(u8x8);
+      break;
+    case U8X8_MSG_DISPLAY_DRAW_TILE:
+      calls++;
+      sum += tile->tile_ptr[0] + tile->tile_ptr[tile->cnt * 8 - 1];
+      break;
+    default:
+      return 0;
+  }
+  return 1;
+}
+
+struct method
+{
+  const char *name;
+  void (*glyph)(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding);
+  uint8_t (*string)(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s);
+  uint8_t n;
+};
+
+static const struct method methods[] =
+{
+  { "2x2 glyph", u8x8_Draw2x2Glyph, NULL, 2 },
+  { "3x3 glyph", u8x8_Draw3x3Glyph, NULL, 3 },
+  { "4x4 glyph", u8x8_Draw4x4Glyph, NULL, 4 },
+  { "2x2 string", NULL, u8x8_Draw2x2String, 2 },
+  { "3x3 string", NULL, u8x8_Draw3x3String, 3 },
+  { "4x4 string", NULL, u8x8_Draw4x4String, 4 },
+};
+
+/* ns per glyph */
+static double measure(u8x8_t *u8x8, const struct method *m, double seconds, double *calls_per_glyph)
+{
+  long glyphs = 0;
+  double start, end;
+  int i;
+
+  calls = 0;
+  start = now_ns();
+  do
+  {
+    if ( m->glyph )
+    {
+      for( i = 0; i < 32; i++ )
+	m->glyph(u8x8, 0, 0, lines[i / 8][i % 8]);
+    }
+    else
+    {
+      for( i = 0; i < 4; i++ )
+	m->string(u8x8, 0, 0, lines[i]);
+    }
+    glyphs += 32;
+    end = now_ns();
+  } while( end - start < seconds * 1e9 );
+  *calls_per_glyph = (double)calls / glyphs;
+  return (end - start) / glyphs;
+}
+
+int main(int argc, char **argv)
+{
+  double seconds = 0.25;
+  double ns, ns_2x2[2] = { 0, 0 }, calls_per_glyph;
+  u8x8_t u8x8;
+  size_t m;
+  int i;
+
+  for( i = 1; i < argc; i++ )
+  {
+    if ( strcmp(argv[i], "-t") == 0 && i + 1 < argc )
+      seconds = atof(argv[++i]);
+    else
+    {
+      fprintf(stderr, "usage: %s [-t seconds]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  /* 256x64 pixel, a 4x4 string of 8 glyphs fits into one line */
+  display_info.tile_width = 32;
+  display_info.tile_height = 8;
+  display_info.pixel_width = 256;
+  display_info.pixel_height = 64;
+  u8x8_Setup(&u8x8, u8x8_d_sum, u8x8_cad_empty, u8x8_byte_empty, u8x8_dummy_cb);
+  u8x8_InitDisplay(&u8x8);
+  u8x8_SetFont(&u8x8, u8x8_font_chroma48medium8_r);
+
+  printf("%-11s %10s %10s %12s %10s\n", "", "ns/glyph", "Mtile/s", "calls/glyph", "tile/2x2");
+  for( m = 0; m < sizeof(methods) / sizeof(methods[0]); m++ )
+  {
+    const struct method *method = methods + m;
+    ns = measure(&u8x8, method, seconds, &calls_per_glyph);
+    if ( method->n == 2 )
+      ns_2x2[method->glyph == NULL] = ns;
+    printf("%-11s %10.1f %10.1f %12.2f %10.2f\n", method->name, ns,
+      method->n * method->n * 1e3 / ns, calls_per_glyph,
+      ns / (method->n * method->n) / (ns_2x2[method->glyph == NULL] / 4));
+  }
+  return sum == 0xffffffff;	/* keeps the sum */
+}
@@ -0,0 +1,394 @@
+/*
+
+  u8x8_string_test.c
+
+  Checks the string procedures of u8x8_8x8.c, which collect the tiles of
+  several glyphs and send them with one u8x8_DrawTile() call:
+  u8x8_DrawString(), u8x8_DrawUTF8(), u8x8_Draw1x2String/UTF8() and
+  u8x8_Draw2x2String/UTF8(), u8x8_Draw3x3String/UTF8() and
+  u8x8_Draw4x4String/UTF8(). Random strings are drawn at random positions
+  on a memory display, which records each DRAW_TILE call, and the tiles
+  must equal a naive reference, which sets each pixel of the upscaled
+  glyphs from the font data. The same is done for the single glyphs of
+  u8x8_DrawGlyph() up to u8x8_Draw4x4Glyph(), also with fonts of 2x4
+  tiles per glyph, in normal and inverse mode. Strings crossing the right
+  edge are drawn only up to the edge: no DRAW_TILE call may extend past
+  the display width.
+
+  The second part counts the transfers and bytes of a SSD1306 over I2C
+  with a byte callback, for the glyph by glyph drawing and the strings.
+
+*/
+
+#include "u8x8.h"
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_WIDTH 16
+#define MAX_HEIGHT 16
+
+static int fails;
+
+#define CHECK(c) do { if ( !(c) ) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); fails++; } } while( 0 )
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(uint32_t n)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % n;
+}
+
+/*==============================================*/
+/* memory display: records the DRAW_TILE calls and keeps the tiles inside the display */
+
+static uint8_t tiles[MAX_HEIGHT][MAX_WIDTH][8];
+static u8x8_display_info_t display_info;
+static int calls, sent_tiles, overruns;
+static uint8_t last_x, last_cnt;
+
+static uint8_t u8x8_d_memory(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr)
+{
+  u8x8_tile_t *tile = (u8x8_tile_t *)arg_ptr;
+  uint8_t i;
+  switch( msg )
+  {
+    case U8X8_MSG_DISPLAY_SETUP_MEMORY:
+      u8x8_d_helper_display_setup_memory(u8x8, &display_info);
+      break;
+    case U8X8_MSG_DISPLAY_INIT:
+      u8x8_d_helper_display_init(u8x8);
+      break;
+    case U8X8_MSG_DISPLAY_DRAW_TILE:
+      calls++;
+      sent_tiles += tile->cnt * arg_int;
+      last_x = tile->x_pos;
+      last_cnt = tile->cnt;
+      if ( tile->x_pos + tile->cnt * arg_int > display_info.tile_width )
+	overruns++;
+      for( i = 0; i < tile->cnt * arg_int; i++ )
+	if ( tile->x_pos + i < display_info.tile_width && tile->y_pos < display_info.tile_height )
+	  memcpy(tiles[tile->y_pos][tile->x_pos + i], tile->tile_ptr + (i % tile->cnt) * 8, 8);
+      break;
+    default:
+      return 0;
+  }
+  return 1;
+}
+
+static void setup_display(u8x8_t *u8x8, uint8_t width, uint8_t height)
+{
+  memset(&display_info, 0, sizeof(display_info));
+  display_info.tile_width = width;
+  display_info.tile_height = height;
+  display_info.pixel_width = width * 8;
+  display_info.pixel_height = height * 8;
+  u8x8_Setup(u8x8, u8x8_d_memory, u8x8_cad_empty, u8x8_byte_empty, u8x8_dummy_cb);
+  u8x8_InitDisplay(u8x8);
+}
+
+/*==============================================*/
+/* naive reference: each pixel of the glyph is replicated sx times sy */
+
+static uint8_t expected[MAX_HEIGHT][MAX_WIDTH][8];
+
+static uint8_t is_inverse;
+
+static uint8_t glyph_pixel(const uint8_t *font, uint8_t encoding, uint16_t px, uint16_t py)
+{
+  uint8_t th = font[2], tv = font[3];
+  uint16_t tile;
+  if ( encoding < font[0] || encoding > font[1] )
+    return is_inverse;
+  tile = (encoding - font[0]) * th * tv + (py / 8) * th + px / 8;
+  return ((font[4 + tile * 8 + px % 8] >> (py % 8)) & 1) ^ is_inverse;
+}
+
+static void reference_glyph(const uint8_t *font, uint8_t sx, uint8_t sy, uint16_t x, uint8_t y, uint8_t encoding)
+{
+  uint16_t px, py, tx, ty;
+  for( py = 0; py < font[3] * 8 * sy; py++ )
+    for( px = 0; px < font[2] * 8 * sx; px++ )
+    {
+      tx = x + px / 8;
+      ty = y + py / 8;
+      if ( tx >= display_info.tile_width || ty >= display_info.tile_height )
+	continue;
+      if ( glyph_pixel(font, encoding, px / sx, py / sy) )
+	expected[ty][tx][px % 8] |= 1 << (py % 8);
+    }
+}
+
+/* returns the number of glyphs */
+static uint8_t reference_string(u8x8_t *u8x8, const uint8_t *font, uint8_t sx, uint8_t sy, uint8_t is_utf8, uint8_t x, uint8_t y, const char *s)
+{
+  uint16_t e, xx = x;
+  uint8_t cnt = 0;
+  memset(expected, 0, sizeof(expected));
+  u8x8_utf8_init(u8x8);
+  for( ; ; s++ )
+  {
+    e = is_utf8 ? u8x8_utf8_next(u8x8, (uint8_t)*s) : u8x8_ascii_next(u8x8, (uint8_t)*s);
+    if ( e == 0x0ffff )
+      break;
+    if ( e == 0x0fffe )
+      continue;
+    reference_glyph(font, sx, sy, xx, y, (uint8_t)e);
+    xx += font[2] * sx;
+    cnt++;
+  }
+  return cnt;
+}
+
+/*==============================================*/
+
+struct method
+{
+  const char *name;
+  uint8_t (*draw)(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s);
+  uint8_t sx, sy, is_utf8;
+  const uint8_t *font;
+};
+
+static const struct method methods[] =
+{
+  { "DrawString", u8x8_DrawString, 1, 1, 0, u8x8_font_chroma48medium8_r },
+  { "DrawUTF8", u8x8_DrawUTF8, 1, 1, 1, u8x8_font_amstrad_cpc_extended_f },
+  { "Draw1x2String", u8x8_Draw1x2String, 1, 2, 0, u8x8_font_chroma48medium8_r },
+  { "Draw1x2UTF8", u8x8_Draw1x2UTF8, 1, 2, 1, u8x8_font_amstrad_cpc_extended_f },
+  { "Draw2x2String", u8x8_Draw2x2String, 2, 2, 0, u8x8_font_chroma48medium8_r },
+  { "Draw2x2UTF8", u8x8_Draw2x2UTF8, 2, 2, 1, u8x8_font_amstrad_cpc_extended_f },
+  { "Draw3x3String", u8x8_Draw3x3String, 3, 3, 0, u8x8_font_chroma48medium8_r },
+  { "Draw3x3UTF8", u8x8_Draw3x3UTF8, 3, 3, 1, u8x8_font_amstrad_cpc_extended_f },
+  { "Draw4x4String", u8x8_Draw4x4String, 4, 4, 0, u8x8_font_chroma48medium8_r },
+  { "Draw4x4UTF8", u8x8_Draw4x4UTF8, 4, 4, 1, u8x8_font_amstrad_cpc_extended_f },
+  /* glyphs with 2x4 tiles are drawn one by one */
+  { "DrawString 2x4", u8x8_DrawString, 1, 1, 0, u8x8_font_inb21_2x4_n },
+  { "Draw3x3String 2x4", u8x8_Draw3x3String, 3, 3, 0, u8x8_font_inb21_2x4_n },
+  { "Draw4x4String 2x4", u8x8_Draw4x4String, 4, 4, 0, u8x8_font_inb21_2x4_n },
+};
+
+#define METHOD_CNT (sizeof(methods) / sizeof(methods[0]))
+
+/* ASCII, two byte UTF-8 for the codes 0xa0..0xff */
+static void random_string(char *s, uint8_t is_utf8, int len)
+{
+  int i;
+  uint8_t c;
+  for( i = 0; i < len; i++ )
+  {
+    if ( is_utf8 && rnd(3) == 0 )
+    {
+      c = 0xa0 + rnd(0x60);
+      *s++ = 0xc0 | (c >> 6);
+      *s++ = 0x80 | (c & 0x3f);
+    }
+    else
+      *s++ = ' ' + rnd(95);
+  }
+  *s = '\0';
+}
+
+static void test_random(uint8_t width, uint8_t height, int cases)
+{
+  static char s[80];
+  u8x8_t u8x8;
+  size_t m;
+  int i, differ;
+  uint8_t x, y, cnt, ref_cnt;
+
+  setup_display(&u8x8, width, height);
+  for( m = 0; m < METHOD_CNT; m++ )
+  {
+    const struct method *method = methods + m;
+    differ = 0;
+    overruns = 0;
+    u8x8_SetFont(&u8x8, method->font);
+    for( i = 0; i < cases; i++ )
+    {
+      random_string(s, method->is_utf8, rnd(i % 8 == 0 ? 3 : 24));
+      x = rnd(width + 2);
+      y = rnd(height);
+      is_inverse = rnd(4) == 0;
+      u8x8_SetInverseFont(&u8x8, is_inverse);
+      ref_cnt = reference_string(&u8x8, method->font, method->sx, method->sy, method->is_utf8, x, y, s);
+      memset(tiles, 0, sizeof(tiles));
+      cnt = method->draw(&u8x8, x, y, s);
+      CHECK(cnt == ref_cnt);
+      if ( memcmp(tiles, expected, sizeof(tiles)) != 0 )
+	differ++;
+    }
+    if ( differ != 0 || overruns != 0 )
+      printf("FAIL %dx%d %s: %d differences, %d tile runs past the width\n", width, height, method->name, differ, overruns);
+    fails += differ + overruns;
+  }
+  u8x8_SetInverseFont(&u8x8, 0);
+  is_inverse = 0;
+  printf("%2dx%-2d %d strings for each procedure checked\n", width, height, cases);
+}
+
+struct glyph_method
+{
+  const char *name;
+  void (*draw)(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding);
+  uint8_t sx, sy;
+};
+
+static const struct glyph_method glyph_methods[] =
+{
+  { "DrawGlyph", u8x8_DrawGlyph, 1, 1 },
+  { "Draw1x2Glyph", u8x8_Draw1x2Glyph, 1, 2 },
+  { "Draw2x2Glyph", u8x8_Draw2x2Glyph, 2, 2 },
+  { "Draw3x3Glyph", u8x8_Draw3x3Glyph, 3, 3 },
+  { "Draw4x4Glyph", u8x8_Draw4x4Glyph, 4, 4 },
+};
+
+/* every glyph of the fonts at random positions, also partly outside of the display */
+static void test_glyphs(void)
+{
+  static const uint8_t *fonts[] = { u8x8_font_chroma48medium8_r, u8x8_font_amstrad_cpc_extended_f, u8x8_font_inb21_2x4_n };
+  u8x8_t u8x8;
+  size_t m, f;
+  int e, differ, glyphs = 0;
+  uint8_t x, y;
+
+  setup_display(&u8x8, 16, 16);
+  for( m = 0; m < sizeof(glyph_methods) / sizeof(glyph_methods[0]); m++ )
+  {
+    const struct glyph_method *method = glyph_methods + m;
+    differ = 0;
+    overruns = 0;
+    for( f = 0; f < sizeof(fonts) / sizeof(fonts[0]); f++ )
+    {
+      u8x8_SetFont(&u8x8, fonts[f]);
+      for( is_inverse = 0; is_inverse <= 1; is_inverse++ )
+      {
+	u8x8_SetInverseFont(&u8x8, is_inverse);
+	for( e = 0; e < 256; e++ )
+	{
+	  x = rnd(18);
+	  y = rnd(16);
+	  memset(expected, 0, sizeof(expected));
+	  reference_glyph(fonts[f], method->sx, method->sy, x, y, e);
+	  memset(tiles, 0, sizeof(tiles));
+	  method->draw(&u8x8, x, y, e);
+	  if ( memcmp(tiles, expected, sizeof(tiles)) != 0 )
+	    differ++;
+	  glyphs++;
+	}
+      }
+    }
+    if ( differ != 0 || overruns != 0 )
+      printf("FAIL %s: %d differences, %d tile runs past the width\n", method->name, differ, overruns);
+    fails += differ + overruns;
+  }
+  is_inverse = 0;
+  printf("%d glyphs checked\n", glyphs);
+}
+
+/* a run of tiles crossing the right edge is cut at the edge */
+static void test_right_edge(void)
+{
+  u8x8_t u8x8;
+  setup_display(&u8x8, 16, 8);
+  u8x8_SetFont(&u8x8, u8x8_font_chroma48medium8_r);
+
+  calls = 0; overruns = 0;
+  CHECK(u8x8_DrawString(&u8x8, 13, 0, "ABCDEFGH") == 8);
+  CHECK(calls == 1 && last_x == 13 && last_cnt == 3);
+
+  /* the second run starts past the edge and is not sent */
+  calls = 0;
+  CHECK(u8x8_DrawString(&u8x8, 4, 1, "0123456789abcdefghij") == 20);
+  CHECK(calls == 2 && last_x == 12 && last_cnt == 4);
+
+  /* the edge cuts a 2x2 glyph: one tile of the upper and of the lower row */
+  calls = 0; sent_tiles = 0;
+  CHECK(u8x8_Draw2x2String(&u8x8, 11, 2, "ABC") == 3);
+  CHECK(calls == 2 && sent_tiles == 10 && last_x == 11 && last_cnt == 5);
+  calls = 0; sent_tiles = 0;
+  u8x8_Draw2x2Glyph(&u8x8, 15, 4, 'A');
+  CHECK(calls == 2 && sent_tiles == 2);
+
+  calls = 0;
+  CHECK(u8x8_Draw1x2UTF8(&u8x8, 16, 6, "A\xc3\xa4") == 2);
+  CHECK(calls == 0);
+
+  /* 4x4: each of the four rows is cut after two tiles */
+  calls = 0; sent_tiles = 0;
+  CHECK(u8x8_Draw4x4String(&u8x8, 14, 0, "AB") == 2);
+  CHECK(calls == 4 && sent_tiles == 8 && last_x == 14 && last_cnt == 2);
+  CHECK(overruns == 0);
+}
+
+/*==============================================*/
+/* transfers and bytes of a SSD1306 over I2C */
+
+static uint32_t transfers, bytes;
+
+static uint8_t u8x8_byte_count(U8X8_UNUSED u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, U8X8_UNUSED void *arg_ptr)
+{
+  switch( msg )
+  {
+    case U8X8_MSG_BYTE_SEND:
+      bytes += arg_int;
+      break;
+    case U8X8_MSG_BYTE_START_TRANSFER:
+      transfers++;
+      break;
+    case U8X8_MSG_BYTE_INIT:
+    case U8X8_MSG_BYTE_SET_DC:
+    case U8X8_MSG_BYTE_END_TRANSFER:
+      break;
+    default:
+      return 0;
+  }
+  return 1;
+}
+
+static void measure(u8x8_t *u8x8, const char *name, void (*glyph)(u8x8_t *u8x8, uint8_t x, uint8_t y, uint8_t encoding),
+  uint8_t (*draw)(u8x8_t *u8x8, uint8_t x, uint8_t y, const char *s), uint8_t advance, const char *s)
+{
+  uint32_t glyph_transfers, glyph_bytes;
+  uint8_t x = 0;
+  const char *p;
+
+  transfers = 0; bytes = 0;
+  for( p = s; *p != '\0'; p++ )
+  {
+    glyph(u8x8, x, 0, *p);
+    x += advance;
+  }
+  glyph_transfers = transfers;
+  glyph_bytes = bytes;
+
+  transfers = 0; bytes = 0;
+  draw(u8x8, 0, 0, s);
+  CHECK(transfers < glyph_transfers && bytes < glyph_bytes);
+  printf("%-16s %5d %10lu %10lu %10lu %10lu\n", name, (int)strlen(s), (unsigned long)glyph_transfers,
+    (unsigned long)glyph_bytes, (unsigned long)transfers, (unsigned long)bytes);
+}
+
+static void test_bus(void)
+{
+  u8x8_t u8x8;
+  u8x8_Setup(&u8x8, u8x8_d_ssd1306_128x64_noname, u8x8_cad_ssd13xx_fast_i2c, u8x8_byte_count, u8x8_dummy_cb);
+  u8x8_InitDisplay(&u8x8);
+  u8x8_SetFont(&u8x8, u8x8_font_chroma48medium8_r);
+
+  printf("%-16s %5s %10s %10s %10s %10s\n", "ssd1306 i2c", "chars", "glyph xfer", "glyph byte", "str xfer", "str byte");
+  measure(&u8x8, "DrawString", u8x8_DrawGlyph, u8x8_DrawString, 1, "0123456789abcdef");
+  measure(&u8x8, "Draw1x2String", u8x8_Draw1x2Glyph, u8x8_Draw1x2String, 1, "0123456789abcdef");
+  measure(&u8x8, "Draw2x2String", u8x8_Draw2x2Glyph, u8x8_Draw2x2String, 2, "01234567");
+}
+
+int main(void)
+{
+  test_right_edge();
+  test_glyphs();
+  test_random(16, 8, 3000);
+  test_random(13, 8, 3000);
+  test_bus();
+  printf(fails ? "%d FAILED\n" : "all passed\n", fails);
+  return fails != 0;
+}
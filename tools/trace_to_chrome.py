@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""Convert a binary trace dump ("GetSetting trace", see class Trace in
+src/vibration-sensor.cpp) to Chrome trace JSON (chrome://tracing, Perfetto).
+
+Capture the raw bytes from the USB serial port while calling GetSetting
+with "trace", e.g.
+    cat /dev/ttyACM0 > trace.bin
+and convert them:
+    python3 tools/trace_to_chrome.py trace.bin > trace.json
+Anything before the "TRC2" marker (log output) is skipped. The first dump
+whose length and CRC-32 trailer match is converted, a damaged dump is
+rejected.
+"""
+
+import json
+import struct
+import sys
+import zlib
+
+
+def parse(data):
+    start = data.find(b"TRC2")
+    if start < 0:
+        raise ValueError("no TRC2 marker found")
+    while start >= 0:
+        try:
+            return parse_at(data, start)
+        except (ValueError, IndexError, struct.error):
+            start = data.find(b"TRC2", start + 1)
+    raise ValueError("no complete dump with a valid trailer found")
+
+
+def parse_at(data, start):
+    pos = start + 4
+    num_names = data[pos]
+    pos += 1
+    names = []
+    for _ in range(num_names):
+        end = data.index(b"\0", pos)
+        names.append(data[pos:end].decode("ascii"))
+        pos = end + 1
+    (count,) = struct.unpack_from("<I", data, pos)
+    pos += 4
+    events = []
+    for _ in range(count):
+        us, event_id, phase = struct.unpack_from("<IHH", data, pos)
+        pos += 8
+        events.append((us, event_id, phase))
+    length, crc = struct.unpack_from("<II", data, pos)
+    if length != pos - start or crc != zlib.crc32(data[start:pos]):
+        raise ValueError("trailer does not match, damaged dump")
+    return names, events
+
+
+def to_chrome(names, events):
+    trace_events = []
+    offset = 0
+    last = None
+    for us, event_id, phase in events:
+        # micros() wraps every ~71.6 minutes
+        if last is not None and us < last:
+            offset += 1 << 32
+        last = us
+        name = names[event_id] if event_id < len(names) else "id %d" % event_id
+        trace_events.append({
+            "name": name,
+            "ph": "B" if phase == 0 else "E",
+            "ts": us + offset,
+            "pid": 0,
+            "tid": 0,
+        })
+    return {"traceEvents": trace_events, "displayTimeUnit": "ms"}
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("usage: trace_to_chrome.py <dump file>")
+    with open(sys.argv[1], "rb") as f:
+        try:
+            names, events = parse(f.read())
+        except ValueError as e:
+            sys.exit("trace_to_chrome.py: %s" % e)
+    json.dump(to_chrome(names, events), sys.stdout, indent=1)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main()